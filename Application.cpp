@@ -15,6 +15,36 @@ namespace ClassGame {
         bool gameOver = false;
         int gameWinner = -1;
 
+        // the settings panel's copy of the board state, only rebuilt when a turn ends or the game changes
+        // (cleared whenever game is replaced or reset, a new game can reuse the old one's address and turn counts)
+        std::string cachedState;
+        bool cachedStateValid = false;
+        unsigned int cachedStateTurn = 0;
+        size_t cachedStateTurns = 0;
+
+        const std::string &currentStateString()
+        {
+            if (!cachedStateValid || game->getCurrentTurnNo() != cachedStateTurn || game->_turns.size() != cachedStateTurns) {
+                cachedState = game->stateString();
+                cachedStateValid = true;
+                cachedStateTurn = game->getCurrentTurnNo();
+                cachedStateTurns = game->_turns.size();
+            }
+            return cachedState;
+        }
+
+        void startNewGame(Game *newGame)
+        {
+            game = newGame;
+            game->setUpBoard();
+            cachedStateValid = false;
+        }
+
+        void SetRedrawRequest(void (*request)())
+        {
+            Game::setRedrawRequest(request);
+        }
+
         //
         // game starting point
         // this is called by the main render loop in main.cpp
@@ -22,8 +52,22 @@ namespace ClassGame {
         void GameStartUp() 
         {
             game = nullptr;
+            cachedStateValid = false;
 
-            Logger::GetInstance().LogInfo("game starting...");
+            LOG_INFO("game starting...");
+        }
+
+        //
+        // game shutdown
+        // this is called by main.cpp before it tears down the window, so stopGame
+        // has to cancel and wait for anything still running on another thread
+        //
+        void GameShutDown()
+        {
+            if (game) {
+                game->stopGame();
+            }
+            SetRedrawRequest(nullptr);
         }
 
         //
@@ -46,47 +90,43 @@ namespace ClassGame {
                     if (ImGui::Button("Reset Game")) {
                         game->stopGame();
                         game->setUpBoard();
+                        cachedStateValid = false;
                         gameOver = false;
                         gameWinner = -1;
                     }
                 }
                 if (!game) {
                     if (ImGui::Button("Start Tic-Tac-Toe")) {
-                        game = new TicTacToe();
-                        game->setUpBoard();
+                        startNewGame(new TicTacToe());
                     }
                     if (ImGui::Button("Start Checkers")) {
-                        game = new Checkers();
-                        game->setUpBoard();
+                        startNewGame(new Checkers());
                     }
                     if (ImGui::Button("Start Othello")) {
-                        game = new Othello();
-                        game->setUpBoard();
+                        startNewGame(new Othello());
                     }
                     if (ImGui::Button("Start Connect 4")) {
-                        game = new Connect4();
-                        game->setUpBoard();
+                        startNewGame(new Connect4());
                     }
                     if (ImGui::Button("Start Chess")) {
-                        game = new Chess();
-                        game->setUpBoard();
+                        startNewGame(new Chess());
                     }
                 } else {
                     ImGui::Text("Current Player Number: %d", game->getCurrentPlayer()->playerNumber());
-                    std::string stateString = game->stateString();
+                    const std::string &stateString = currentStateString();
                     int stride = game->_gameOptions.rowX;
                     int height = game->_gameOptions.rowY;
 
                     for(int y=0; y<height; y++) {
                         ImGui::Text("%s", stateString.substr(y*stride,stride).c_str());
                     }
-                    ImGui::Text("Current Board State: %s", game->stateString().c_str());
+                    ImGui::Text("Current Board State: %s", stateString.c_str());
                 }
                 ImGui::End();
 
                 ImGui::Begin("GameWindow");
                 if (game) {
-                    if (game->gameHasAI() && (game->getCurrentPlayer()->isAIPlayer() || game->_gameOptions.AIvsAI))
+                    if (!gameOver && game->gameHasAI() && (game->getCurrentPlayer()->isAIPlayer() || game->_gameOptions.AIvsAI))
                     {
                         game->updateAI();
                     }
@@ -95,6 +135,26 @@ namespace ClassGame {
                 ImGui::End();
         }
 
+        //
+        // the main loop sleeps between input events unless this says something is moving on its own
+        //
+        bool NeedsContinuousRedraw()
+        {
+            if (ImGui::IsAnyItemActive() || ImGui::IsAnyMouseDown()) {
+                return true;
+            }
+            if (!game) {
+                return false;
+            }
+            // the AI is polled once a frame, same test as the updateAI call above, but one that thinks on
+            // another thread wakes the loop itself when it has progress or a move to show
+            if (!gameOver && game->gameHasAI() && (game->getCurrentPlayer()->isAIPlayer() || game->_gameOptions.AIvsAI)
+                && !game->isAIThinking()) {
+                return true;
+            }
+            return game->isAnimating();
+        }
+
         //
         // end turn is called by the game code at the end of each turn
         // this is where we check for a winner
@@ -2,6 +2,11 @@
 
 namespace ClassGame {
     void GameStartUp();
+    // called by the main loop on the way out, before the platform layer is torn down
+    void GameShutDown();
     void RenderGame();
     void EndOfTurn();
+    bool NeedsContinuousRedraw();
+    // how a background thread wakes the main loop, glfwPostEmptyEvent with glfw
+    void SetRedrawRequest(void (*request)());
 }
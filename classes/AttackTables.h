@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+
+//
+// attack tables for the leapers and pawns, plus between/line tables for every pair of squares
+// all of it is worked out at compile time, so there's nothing to build at startup and every
+// game instance shares the same read-only copy. only the sliders still need the magic tables
+//
+
+struct AttackTables {
+    uint64_t knight[64];
+    uint64_t king[64];
+    uint64_t pawn[2][64];           // [color][square], the squares a pawn of that color attacks
+    uint64_t between[64][64];       // squares strictly between two squares on a shared rank, file or diagonal
+    uint64_t line[64][64];          // the whole rank, file or diagonal through two squares
+};
+
+// the square one step of (rowStep, colStep) away, -1 off the board
+constexpr int attackStep(int square, int rowStep, int colStep) {
+    int row = square / 8 + rowStep;
+    int col = square % 8 + colStep;
+    return (row >= 0 && row < 8 && col >= 0 && col < 8) ? row * 8 + col : -1;
+}
+
+// every square from square (not included) to the edge of the board in one direction
+constexpr uint64_t attackRay(int square, int rowStep, int colStep) {
+    uint64_t ray = 0;
+    for (int next = attackStep(square, rowStep, colStep); next >= 0; next = attackStep(next, rowStep, colStep)) {
+        ray |= 1ULL << next;
+    }
+    return ray;
+}
+
+constexpr AttackTables generateAttackTables() {
+    AttackTables tables{};
+    const int knightSteps[8][2] = { {2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2} };
+    const int kingSteps[8][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+
+    for (int square = 0; square < 64; square++) {
+        for (int i = 0; i < 8; i++) {
+            int knight = attackStep(square, knightSteps[i][0], knightSteps[i][1]);
+            if (knight >= 0) tables.knight[square] |= 1ULL << knight;
+            int king = attackStep(square, kingSteps[i][0], kingSteps[i][1]);
+            if (king >= 0) tables.king[square] |= 1ULL << king;
+        }
+
+        // white pawns attack up the board, black pawns down
+        for (int colStep = -1; colStep <= 1; colStep += 2) {
+            int white = attackStep(square, 1, colStep);
+            if (white >= 0) tables.pawn[0][square] |= 1ULL << white;
+            int black = attackStep(square, -1, colStep);
+            if (black >= 0) tables.pawn[1][square] |= 1ULL << black;
+        }
+
+        // the king steps double as the eight slider directions
+        for (int i = 0; i < 8; i++) {
+            int rowStep = kingSteps[i][0];
+            int colStep = kingSteps[i][1];
+            uint64_t line = (1ULL << square) | attackRay(square, rowStep, colStep) | attackRay(square, -rowStep, -colStep);
+            uint64_t between = 0;
+            for (int next = attackStep(square, rowStep, colStep); next >= 0; next = attackStep(next, rowStep, colStep)) {
+                tables.between[square][next] = between;
+                tables.line[square][next] = line;
+                between |= 1ULL << next;
+            }
+        }
+    }
+    return tables;
+}
+
+inline constexpr AttackTables Attacks = generateAttackTables();
+
+// the names the move generator uses
+inline constexpr const uint64_t (&KnightAttacks)[64] = Attacks.knight;
+inline constexpr const uint64_t (&KingAttacks)[64] = Attacks.king;
+inline constexpr const uint64_t (&PawnAttacks)[2][64] = Attacks.pawn;
+inline constexpr const uint64_t (&BetweenSquares)[64][64] = Attacks.between;
+inline constexpr const uint64_t (&LineSquares)[64][64] = Attacks.line;
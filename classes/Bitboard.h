@@ -4,6 +4,37 @@
 #include <intrin.h>
 #endif
 #include <iostream>
+#include <stdint.h>
+
+typedef uint64_t BitBoard;
+constexpr BitBoard BitZero = 1ULL;
+
+constexpr int WHITE = 0;
+constexpr int BLACK = 1;
+
+// rows (for bitboard stuff)
+constexpr uint64_t ROW_1 = 0x00000000000000FFULL;
+constexpr uint64_t ROW_2 = 0x000000000000FF00ULL;
+constexpr uint64_t ROW_3 = 0x0000000000FF0000ULL;
+constexpr uint64_t ROW_4 = 0x00000000FF000000ULL;
+constexpr uint64_t ROW_5 = 0x000000FF00000000ULL;
+constexpr uint64_t ROW_6 = 0x0000FF0000000000ULL;
+constexpr uint64_t ROW_7 = 0x00FF000000000000ULL;
+constexpr uint64_t ROW_8 = 0xFF00000000000000ULL;
+
+// cols
+constexpr uint64_t COL_1 = 0x0101010101010101ULL;
+constexpr uint64_t COL_2 = COL_1 << 1;
+constexpr uint64_t COL_3 = COL_1 << 2;
+constexpr uint64_t COL_4 = COL_1 << 3;
+constexpr uint64_t COL_5 = COL_1 << 4;
+constexpr uint64_t COL_6 = COL_1 << 5;
+constexpr uint64_t COL_7 = COL_1 << 6;
+constexpr uint64_t COL_8 = COL_1 << 7;
+
+// precompute for pawn movement
+constexpr uint64_t NOT_COL_1 = ~COL_1;
+constexpr uint64_t NOT_COL_8 = ~COL_8;
 
 enum ChessPiece
 {
@@ -80,19 +111,74 @@ private:
 
 };
 
+// special move flags. the capture and promotion bits can be tested on their own,
+// the low two bits of a promotion pick the piece (knight, bishop, rook, queen)
+enum MoveFlags
+{
+    MoveQuiet       = 0,
+    MoveDoublePush  = 1,
+    MoveKingCastle  = 2,
+    MoveQueenCastle = 3,
+    MoveCapture     = 4,
+    MoveEnPassant   = 5,
+    MovePromotion   = 8
+};
+
+// a move packed into 16 bits: from square in bits 0-5, to square in bits 6-11, flags in 12-15
+// the piece that moves isn't stored, it's whatever stands on the from square
 struct BitMove {
-    uint8_t from;
-    uint8_t to;
-    uint8_t piece;
-    
-    BitMove(int from, int to, ChessPiece piece)
-        : from(from), to(to), piece(piece) { }
-        
-    BitMove() : from(0), to(0), piece(NoPiece) { }
-    
-    bool operator==(const BitMove& other) const {
-        return from == other.from && 
-               to == other.to && 
-               piece == other.piece;
-    }
+    uint16_t data;
+
+    BitMove(int from, int to, int flags = MoveQuiet)
+        : data(uint16_t(from | (to << 6) | (flags << 12))) { }
+
+    BitMove() : data(0) { }
+
+    static BitMove fromPacked(uint16_t packed) { BitMove move; move.data = packed; return move; }
+    uint16_t packed() const { return data; }
+
+    int from() const { return data & 63; }
+    int to() const { return (data >> 6) & 63; }
+    int flags() const { return data >> 12; }
+
+    // from == to, what a search hands back when there's nothing to play
+    bool isNull() const { return from() == to(); }
+    bool isCapture() const { return flags() & MoveCapture; }
+    bool isPromotion() const { return flags() & MovePromotion; }
+    bool isEnPassant() const { return flags() == MoveEnPassant; }
+    bool isCastle() const { return flags() == MoveKingCastle || flags() == MoveQueenCastle; }
+    ChessPiece promotionPiece() const { return isPromotion() ? ChessPiece(Knight + (flags() & 3)) : NoPiece; }
+
+    bool operator==(const BitMove& other) const { return data == other.data; }
+};
+
+static_assert(sizeof(BitMove) == 2, "moves should pack into 16 bits");
+
+// fixed capacity list of moves, small enough to live on the stack so generating moves never
+// touches the heap. no legal position has more than 218 moves
+class MoveList {
+public:
+    static constexpr int Capacity = 256;
+
+    MoveList() : _size(0) { }
+
+    void add(BitMove move) { _moves[_size++] = move; }
+    void add(int from, int to, int flags) { _moves[_size++] = BitMove(from, to, flags); }
+
+    int size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    void clear() { _size = 0; }
+    // only ever shrinks, for filtering the list in place
+    void resize(int size) { _size = size; }
+
+    BitMove& operator[](int index) { return _moves[index]; }
+    const BitMove& operator[](int index) const { return _moves[index]; }
+    BitMove* begin() { return _moves; }
+    BitMove* end() { return _moves + _size; }
+    const BitMove* begin() const { return _moves; }
+    const BitMove* end() const { return _moves + _size; }
+
+private:
+    BitMove _moves[Capacity];
+    int _size;
 };
\ No newline at end of file
@@ -3,27 +3,19 @@
 #include <limits>
 #include <cmath>
 #include <cctype>
-#include <bitset>
 #include <iostream>
 
-Chess::Chess()
+Chess::Chess() : _aiCancel(false), _aiFinished(false), _aiProgressNew(false)
 {
     _grid = new Grid(8, 8);
 }
 
 Chess::~Chess()
 {
+    cancelAISearch();
     delete _grid;
 }
 
-void Log(std::string info) {
-    Logger::GetInstance().LogInfo(info);
-}
-
-void LogUint64(uint64_t bits) {
-    Logger::GetInstance().LogInfo(std::bitset<64>(bits).to_string());
-}
-
 #pragma region TESTS
 
 void Chess::TestStateNotation() {
@@ -39,7 +31,17 @@ void Chess::TestStateNotation() {
         result += ' ';
     }
 
-    Log(result);
+    LOG_DEBUG(result);
+}
+
+void Chess::TestMagicBitboards() {
+
+    int errors = verifyMagicBitboards();
+    if (errors) {
+        LOG_ERROR("magic bitboards: " + std::to_string(errors) + " lookups don't match ratt/batt");
+    } else {
+        LOG_DEBUG("magic bitboards: all lookups match ratt/batt");
+    }
 }
 
 #pragma endregion
@@ -59,14 +61,14 @@ char Chess::pieceNotation(int x, int y) const
 Bit* Chess::PieceForPlayer(const int playerNumber, ChessPiece piece)
 {
     if (piece == 0) {
-        Logger::GetInstance().LogError("Chess piece not assigned");
+        LOG_ERROR("Chess piece not assigned");
         return nullptr;
     }
 
     const char* pieces[] = { "pawn.png", "knight.png", "bishop.png", "rook.png", "queen.png", "king.png" };
 
     Bit* bit = new Bit();
-    // should possibly be cached from player class?
+    // the texture comes out of the sprite cache after the first piece of each kind
     const char* pieceName = pieces[piece - 1];
     std::string spritePath = std::string("") + (playerNumber == 0 ? "w_" : "b_") + pieceName;
     bit->LoadTextureFromFile(spritePath.c_str());
@@ -76,16 +78,9 @@ Bit* Chess::PieceForPlayer(const int playerNumber, ChessPiece piece)
     return bit;
 }
 
-void Chess::GenerateAllBitboards() {
-
-    for (int i = 0; i < 64; i++) {
-        _kingBitboards[i] = generateKingBitboards(i);
-        _knightBitboards[i] = generateKnightBitboards(i);
-    }
-}
-
 void Chess::setUpBoard()
 {
+    cancelAISearch();
 
     setNumberOfPlayers(2);
     _gameOptions.rowX = 8;
@@ -93,69 +88,48 @@ void Chess::setUpBoard()
 
 
     _grid->initializeChessSquares(pieceSize, "boardsquare.png");
-    FENtoBoard("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR");
+    FENtoBoard(START_FEN);
 
-    GenerateAllBitboards();
+#ifndef NDEBUG
+    TestMagicBitboards();
+#endif
     
-    _moves = generateAllMoves();
+    generateAllMoves();
+
+    if (gameHasAI()) {
+        setAIPlayer(AI_PLAYER);
+        // the AI searches by the clock, AIDepthSearches is its time per move in milliseconds
+        // and AIMAXDepth caps how deep it goes (0 leaves it to the clock)
+        _gameOptions.AIDepthSearches = 1000;
+        _gameOptions.AIMAXDepth = 0;
+        _search.setThreadCount(std::max(1u, std::thread::hardware_concurrency()));
+        // runs on the search thread, so just hand the info over and let the UI thread log it
+        _search.setInfoCallback([this] (const SearchInfo& info) {
+            std::lock_guard<std::mutex> lock(_aiProgressLock);
+            _aiProgress = info;
+            _aiProgressNew = true;
+            requestRedraw();
+        });
+    }
 
     startGame();
 }
 
 void Chess::FENtoBoard(const std::string& fen) {
-    // convert a FEN string to a board
-    // FEN is a space delimited string with 6 fields
-    // 1: piece placement (from white's perspective)
-    // NOT PART OF THIS ASSIGNMENT BUT OTHER THINGS THAT CAN BE IN A FEN STRING
-    // ARE BELOW
-    // 2: active color (W or B)
-    // 3: castling availability (KQkq or -)
-    // 4: en passant target square (in algebraic notation, or -)
-    // 5: halfmove clock (number of halfmoves since the last capture or pawn advance)
-
+    // the position does the FEN parsing, we just create a bit for every piece it ends up with
     _grid->forEachSquare([] (ChessSquare* square, int x, int y) {
         square->setBit(nullptr);
     });
 
-    int row = 7;
-    int col = 0;
-
-    for (char c : fen) {
-
-        if (c == '/') { // move up a row
-            row--;
-            col = 0;
-
-        } else if (isdigit(c)) { // NUMBER
-            col += c - '0'; // move to the right by that many 
-
-        } else { // LETTER
-
-            ChessPiece piece = NoPiece;
-            switch (toupper(c)) {
-                case 'B':
-                    piece = Bishop;
-                    break;
-                case 'K':
-                    piece = King;
-                    break;
-                case 'N':
-                    piece = Knight;
-                    break;
-                case 'P':
-                    piece = Pawn;
-                    break;
-                case 'Q':
-                    piece = Queen;
-                    break;
-                case 'R':
-                    piece = Rook;
-                    break;
-            }
-            int playerNum = !isupper(c);
-            //Log("row: " + std::to_string(row) + ", col: " + std::to_string(col));
-            CreatePieceAt(row, col, playerNum, piece);
-            col++;
+    if (!_position.setFEN(fen)) {
+        LOG_ERROR("invalid FEN: " + fen);
+        return;
+    }
+
+    for (int square = 0; square < 64; square++) {
+        ChessPiece piece = _position.pieceAt(square);
+        if (piece != NoPiece) {
+            CreatePieceAt(square / 8, square % 8, _position.colorAt(square), piece);
         }
     }
 }
@@ -189,8 +163,8 @@ bool Chess::canBitMoveFrom(Bit &bit, BitHolder &src)
     if (square) {
         int index = square->getSquareIndex();
         for (auto move : _moves) {
-            if (move.from == index) { // found a move this piece can do
-                auto dest = _grid->getSquareByIndex(move.to);
+            if (move.from() == index) { // found a move this piece can do
+                auto dest = _grid->getSquareByIndex(move.to());
                 dest->setHighlighted(true);
                 result = true; // don't return yet so we can highlight other found spaces
             }
@@ -208,7 +182,7 @@ bool Chess::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
     if (srcSquare && dstSquare) {
         int srcIndex = srcSquare->getSquareIndex();
         for (auto move : _moves) {
-            if (move.from == srcIndex && move.to == dstSquare->getSquareIndex()) {
+            if (move.from() == srcIndex && move.to() == dstSquare->getSquareIndex()) {
                 return true;
             }
         }
@@ -216,13 +190,163 @@ bool Chess::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
     return false;
 }
 
+void Chess::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
+{
+    ChessSquare* srcSquare = (ChessSquare*)&src;
+    ChessSquare* dstSquare = (ChessSquare*)&dst;
+
+    // the grid has already moved the bit, keep the position in step with it
+    // promotions are listed queen first so dragging a pawn to the last row makes a queen
+    for (auto move : _moves) {
+        if (move.from() == srcSquare->getSquareIndex() && move.to() == dstSquare->getSquareIndex()) {
+            _position.makeMove(move);
+            applyMoveToBoard(move);
+            break;
+        }
+    }
+
+    Game::bitMovedFromTo(bit, src, dst);
+}
+
+// the parts of a move the drag didn't do: the rook in a castle, the pawn taken en passant
+// and the new piece for a promotion
+void Chess::applyMoveToBoard(BitMove move)
+{
+    if (move.isCastle()) {
+        int base = move.to() & 56;
+        int rookFrom = move.flags() == MoveKingCastle ? base + 7 : base;
+        int rookTo = move.flags() == MoveKingCastle ? base + 5 : base + 3;
+        ChessSquare* rookSquare = _grid->getSquareByIndex(rookTo);
+        Bit* rook = _grid->getSquareByIndex(rookFrom)->bit();
+        if (rook) {
+            rookSquare->setBit(rook);
+            rook->moveTo(rookSquare->getPosition());
+        }
+    } else if (move.isEnPassant()) {
+        int capturedSquare = move.to() + (_position.sideToMove() == WHITE ? 8 : -8); // the side that took has already switched
+        _grid->getSquareByIndex(capturedSquare)->destroyBit();
+    } else if (move.isPromotion()) {
+        ChessSquare* square = _grid->getSquareByIndex(move.to());
+        int playerNumber = _position.colorAt(move.to());
+        square->destroyBit();
+        CreatePieceAt(move.to() / 8, move.to() % 8, playerNumber, move.promotionPiece());
+    }
+}
+
 void Chess::endTurn() {
+    // the base class checks for a winner, which needs the new side's moves
+    generateAllMoves();
     Game::endTurn();
-    _moves = generateAllMoves();
+}
+
+void Chess::updateAI()
+{
+    if (!_aiJob.valid()) {
+        startAISearch();
+        return;
+    }
+
+    logAIProgress();
+    if (!_aiFinished) {
+        return;
+    }
+    // at most waits for the job to return the move it just finished with
+    BitMove best = _aiJob.get();
+    logAIProgress(); // the last iteration may have finished since the check above
+    logAIThreads();
+    if (best.isNull()) {
+        return;
+    }
+
+    // move the bit the same way a drag and drop would, then finish the move like bitMovedFromTo does
+    ChessSquare* src = _grid->getSquareByIndex(best.from());
+    ChessSquare* dst = _grid->getSquareByIndex(best.to());
+    Bit* bit = src->bit();
+    if (!bit) {
+        LOG_ERROR("AI move " + moveToUCI(best) + " has no piece on the board");
+        return;
+    }
+    dst->dropBitAtPoint(bit, dst->getPosition());
+    src->draggedBitTo(bit, dst);
+
+    LOG_GAME_EVENT("AI plays " + moveToUCI(best));
+    _position.makeMove(best);
+    applyMoveToBoard(best);
+    endTurn();
+}
+
+void Chess::startAISearch()
+{
+    if (_moves.empty()) {
+        return; // nothing to play, the game is over
+    }
+
+    SearchLimits limits;
+    limits.maxDepth = getAIMAXDepth();
+    limits.moveTimeMs = getAIDepathSearches();
+    limits.stop = &_aiCancel;
+    _aiCancel = false;
+    _aiFinished = false;
+
+    // the search gets its own copy so the board can keep drawing from _position
+    // the main loop sleeps while it runs, so wake it up once the move is ready
+    ChessPosition position = _position;
+    _aiJob = std::async(std::launch::async, [this, position, limits] () mutable {
+        BitMove best = _search.think(position, limits);
+        _aiFinished = true;
+        requestRedraw();
+        return best;
+    });
+}
+
+// stop a search that is still running and throw its move away
+void Chess::cancelAISearch()
+{
+    if (_aiJob.valid()) {
+        _aiCancel = true;
+        _aiJob.wait();
+        _aiJob = std::future<BitMove>();
+    }
+    std::lock_guard<std::mutex> lock(_aiProgressLock);
+    _aiProgressNew = false;
+}
+
+void Chess::logAIThreads()
+{
+    std::vector<SearchThreadInfo> threads = _search.threadInfo();
+    if (threads.size() < 2 || !Logger::GetInstance().IsEnabled(LogLevelDebug)) {
+        return;
+    }
+    std::string line = "search threads (depth/nodes):";
+    for (auto& thread : threads) {
+        line += " " + std::to_string(thread.depth) + "/" + std::to_string(thread.nodes);
+    }
+    LOG_DEBUG(line);
+}
+
+void Chess::logAIProgress()
+{
+    SearchInfo info;
+    {
+        std::lock_guard<std::mutex> lock(_aiProgressLock);
+        if (!_aiProgressNew) {
+            return;
+        }
+        info = _aiProgress;
+        _aiProgressNew = false;
+    }
+
+    std::string pv;
+    for (auto move : info.pv) {
+        pv += " " + moveToUCI(move);
+    }
+    LOG_INFO("depth " + std::to_string(info.depth) + " score " + std::to_string(info.score)
+        + " nodes " + std::to_string(info.nodes) + " nps " + std::to_string(info.nps) + " pv" + pv);
 }
 
 void Chess::stopGame()
 {
+    cancelAISearch();
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
@@ -241,13 +365,33 @@ Player* Chess::ownerAt(int x, int y) const
     return square->bit()->getOwner();
 }
 
+// checkmate, the side to move has no moves and is in check
 Player* Chess::checkForWinner()
 {
+    if (_moves.empty() && _position.inCheck()) {
+        return getPlayerAt(_position.sideToMove() ^ 1);
+    }
     return nullptr;
 }
 
 bool Chess::checkForDraw()
 {
+    if (_moves.empty() && !_position.inCheck()) {
+        LOG_GAME_EVENT("draw by stalemate");
+        return true;
+    }
+    if (_position.halfmoveClock() >= 100) {
+        LOG_GAME_EVENT("draw by the fifty move rule");
+        return true;
+    }
+    if (_position.repetitionCount() >= 2) {
+        LOG_GAME_EVENT("draw by threefold repetition");
+        return true;
+    }
+    if (_position.hasInsufficientMaterial()) {
+        LOG_GAME_EVENT("draw by insufficient material");
+        return true;
+    }
     return false;
 }
 
@@ -295,251 +439,38 @@ int Chess::intNotation(const char *state, int row, int col) {
 
 #pragma region MOVE GENERATION
 
-bool moveInsideChessBoard(int row, int col, int rowDelta, int colDelta) {
-
-    return (row + rowDelta >= 0 && row + rowDelta < 8 && col + colDelta >= 0 && col + colDelta < 8);
-}
-
-void Chess::addMoveIfValid(const char *state, std::vector<BitMove>& moves, int fromRow, int fromCol, int toRow, int toCol, ChessPiece piece) {
-    if (toRow >= 0 && toRow < 8 && toCol >= 0 && toCol < 8) {
-        int from = fromRow * 8 + fromCol;
-        int to = toRow * 8 + toCol;
-        moves.emplace_back(from, to, piece);
-    }
-}
-
-std::vector<BitMove> Chess::generateAllMoves() {
-
-    std::vector<BitMove> moves;
-    moves.reserve(32);
-    std::string state = stateString();
-
-    //Log("state: " + state);
-    //Log(std::to_string(state.length()));
-
-    int currPlayer = getCurrentPlayer()->playerNumber();
-
-    // white pieces
-    uint64_t whitePawns = 0LL;
-    uint64_t whiteRooks = 0LL;
-    uint64_t whiteKnights = 0LL;
-    uint64_t whiteBishops = 0LL;
-    uint64_t whiteKing = 0LL;
-    uint64_t whiteQueens = 0LL;
-
-    // black pieces
-    uint64_t blackPawns = 0LL;
-    uint64_t blackRooks = 0LL;
-    uint64_t blackKnights = 0LL;
-    uint64_t blackBishops = 0LL;
-    uint64_t blackKing = 0LL;
-    uint64_t blackQueens = 0LL;
-
-    // occupancy masks
-    uint64_t whiteOccupancy = 0LL;
-    uint64_t blackOccupancy = 0LL;
-
-    for (int i = 0; i < 64; i++) {
-
-        char piece = state[i];
-
-        if (piece != '0') {
-
-            //Log(std::to_string(piece));
-
-            bool isBlack = islower(piece);
-            if (isBlack) {
-                blackOccupancy |= 1ULL << i;
-            } else {
-                whiteOccupancy |= 1ULL << i;
-            }
-
-            switch(toupper(piece)) {
-
-                case 'B':
-                    if (isBlack) blackBishops |= 1ULL << i;
-                    else whiteBishops |= 1ULL << i;
-                    break;
-                case 'K':
-                    if (isBlack) blackKing |= 1ULL << i;
-                    else whiteKing |= 1ULL << i;
-                    break;
-                case 'N':
-                    if (isBlack) blackKnights |= 1ULL << i;
-                    else whiteKnights |= 1ULL << i;
-                    break;
-                case 'P':
-                    if (isBlack) blackPawns |= 1ULL << i;
-                    else whitePawns |= 1ULL << i;
-                    break;
-                case 'Q':
-                    if (isBlack) blackQueens |= 1ULL << i;
-                    else whiteQueens |= 1ULL << i;
-                    break;
-                case 'R':
-                    if (isBlack) blackRooks |= 1ULL << i;
-                    else whiteRooks |= 1ULL << i;
-                    break;
-            }
-        }
-    }
-
-    uint64_t allOccupancy = whiteOccupancy | blackOccupancy;
-
-    if (currPlayer == BLACK) {
-        generateBlackPawnMoves(moves, blackPawns, ~allOccupancy, whiteOccupancy);
-        generateRookMoves(moves, blackRooks, ~blackOccupancy, allOccupancy);
-        generateKnightMoves(moves, blackKnights, ~blackOccupancy);
-        generateBishopMoves(moves, blackBishops, ~blackOccupancy, allOccupancy);
-        generateQueenMoves(moves, blackQueens, ~blackOccupancy, allOccupancy);
-        generateKingMoves(moves, blackKing, ~blackOccupancy);
-    } else {
-        generateWhitePawnMoves(moves, whitePawns, ~allOccupancy, blackOccupancy);
-        generateRookMoves(moves, whiteRooks, ~whiteOccupancy, allOccupancy);
-        generateKnightMoves(moves, whiteKnights, ~whiteOccupancy);
-        generateBishopMoves(moves, whiteBishops, ~whiteOccupancy, allOccupancy);
-        generateQueenMoves(moves, whiteQueens, ~whiteOccupancy, allOccupancy);
-        generateKingMoves(moves, whiteKing, ~whiteOccupancy);
-    }
-
-    Log("available moves: " + std::to_string(moves.size()));
-
-    return moves;
-}
-
-void Chess::addPawnMoves(std::vector<BitMove>& moves, BitboardElement pawnMoves, int shift) {
-    
-    pawnMoves.forEachBit([&] (int toSquare) {
-        int fromSquare = toSquare + shift;
-        moves.emplace_back(fromSquare, toSquare, Pawn);
-    });
-}
-
-void Chess::generateWhitePawnMoves(std::vector<BitMove>& moves, BitboardElement pawnBoard, uint64_t emptySquares, uint64_t blackOccupancy) {
-
-    // single moves
-    BitboardElement singleMoves = (pawnBoard.getData() << 8) & emptySquares; // shift 8 moves up a whole row
-    addPawnMoves(moves, singleMoves, -8);
-
-    // double moves
-    BitboardElement doubleMoves = ((singleMoves.getData() & ROW_3) << 8) & emptySquares; // only valid single moves forward made into row 3 are eligible
-    addPawnMoves(moves, doubleMoves, -16);
-
-    // left capture
-    BitboardElement leftCaptures = ((pawnBoard.getData() & NOT_COL_1) << 7) & blackOccupancy; // shift 7 moves up and left. leftmost row can't capture left
-    addPawnMoves(moves, leftCaptures, -7);
-
-    // right capture
-    BitboardElement rightCapture = ((pawnBoard.getData() & NOT_COL_8) << 9) & blackOccupancy; // shift 9 moves up and right. rightmost row can't capture right
-    addPawnMoves(moves, rightCapture, -9);
-
-}
-
-void Chess::generateBlackPawnMoves(std::vector<BitMove>& moves, BitboardElement pawnBoard, uint64_t emptySquares, uint64_t whiteOccupancy) {
-
-    // single moves
-    BitboardElement singleMoves = (pawnBoard.getData() >> 8) & emptySquares; // back shift 8 moves down a whole row
-    addPawnMoves(moves, singleMoves, 8);
-
-    // double moves
-    BitboardElement doubleMoves = ((singleMoves.getData() & ROW_6) >> 8) & emptySquares; // only valid single moves forward made into row 6 are eligible
-    addPawnMoves(moves, doubleMoves, 16);
-
-    // left capture
-    BitboardElement leftCaptures = ((pawnBoard.getData() & NOT_COL_1) >> 9) & whiteOccupancy; // shift 9 moves down and left. leftmost row can't capture left
-    addPawnMoves(moves, leftCaptures, 9);
-
-    // right capture
-    BitboardElement rightCapture = ((pawnBoard.getData() & NOT_COL_8) >> 7) & whiteOccupancy; // shift 7 moves down and right. rightmost row can't capture right
-    addPawnMoves(moves, rightCapture, 7);
-    
-}
-
-void Chess::generateRookMoves(std::vector<BitMove>& moves, BitboardElement rookBoard, uint64_t availableSquares, uint64_t blockedSquares) {
-    rookBoard.forEachBit([&] (int fromSquare) {
-        BitboardElement moveBitboard = BitboardElement(ratt(fromSquare, blockedSquares) & availableSquares);
-        LogUint64(moveBitboard.getData());
-        moveBitboard.forEachBit( [&] (int toSquare) {
-            moves.emplace_back(fromSquare, toSquare, Rook);
-        });
-    });
-}
-
-void Chess::generateKnightMoves(std::vector<BitMove>& moves, BitboardElement knightBoard, uint64_t availableSquares) {
-    knightBoard.forEachBit([&] (int fromSquare) {
-        BitboardElement moveBitboard = BitboardElement(_knightBitboards[fromSquare].getData() & availableSquares);
-        moveBitboard.forEachBit( [&] (int toSquare) {
-            moves.emplace_back(fromSquare, toSquare, Knight);
-        });
-    });
-}
+// fills _moves straight from the position, the list is reused turn to turn
+void Chess::generateAllMoves() {
 
-void Chess::generateBishopMoves(std::vector<BitMove>& moves, BitboardElement bishopBoard, uint64_t availableSquares, uint64_t blockedSquares) {
-    bishopBoard.forEachBit([&] (int fromSquare) {
-        BitboardElement moveBitboard = BitboardElement(batt(fromSquare, blockedSquares) & availableSquares);
-        LogUint64(moveBitboard.getData());
-        moveBitboard.forEachBit( [&] (int toSquare) {
-            moves.emplace_back(fromSquare, toSquare, Bishop);
-        });
-    });
-}
+    _moves.clear();
+    _position.generateLegalMoves(_moves);
 
-void Chess::generateQueenMoves(std::vector<BitMove>& moves, BitboardElement queenBoard, uint64_t availableSquares, uint64_t blockedSquares) {
-
-    // horizontal attacks
-    queenBoard.forEachBit([&] (int fromSquare) {
-        BitboardElement moveBitboard = BitboardElement(ratt(fromSquare, blockedSquares) & availableSquares);
-        LogUint64(moveBitboard.getData());
-        moveBitboard.forEachBit( [&] (int toSquare) {
-            moves.emplace_back(fromSquare, toSquare, Queen);
-        });
-    });
-   
-    // diagonal attacks
-    queenBoard.forEachBit([&] (int fromSquare) {
-        BitboardElement moveBitboard = BitboardElement(batt(fromSquare, blockedSquares) & availableSquares);
-        LogUint64(moveBitboard.getData());
-        moveBitboard.forEachBit( [&] (int toSquare) {
-            moves.emplace_back(fromSquare, toSquare, Queen);
-        });
-    });
+    LOG_DEBUG(_position.toFEN() + "  available moves: " + std::to_string(_moves.size()));
 }
 
-void Chess::generateKingMoves(std::vector<BitMove>& moves, BitboardElement kingBoard, uint64_t availableSquares) {
-    kingBoard.forEachBit([&] (int fromSquare) {
-        BitboardElement moveBitboard = BitboardElement(_kingBitboards[fromSquare].getData() & availableSquares);
-        moveBitboard.forEachBit([&] (int toSquare) {
-            moves.emplace_back(fromSquare, toSquare, King);
-        });
-    });
-}
+#pragma endregion
 
 #pragma region Highlight Nonsense
 
 // same as base class, except valid positions don't un-highlight when you drag piece off of them
 void Chess::findDropTarget(ImVec2 &pos)
 {
-	Grid* grid = getGrid();
-	grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-		if (square == _oldHolder)
-		{
-			return;
-		}
-		if (square->isMouseOver(pos))
-		{
-			if (_dropTarget && square != _dropTarget)
-			{
-				_dropTarget->willNotDropBit(_dragBit);
-				//_dropTarget->setHighlighted(false);
-				_dropTarget = nullptr;
-			}
-			if (_oldHolder && square->canDropBitAtPoint(_dragBit, pos) && canBitMoveFromTo(*_dragBit, *_oldHolder, *square))
-			{
-				_dropTarget = square;
-				_dropTarget->setHighlighted(true);
-			}
-		}
-	});
+	ChessSquare *square = getGrid()->getSquareAtPoint(pos);
+	if (!square || square == _oldHolder)
+	{
+		return;
+	}
+	if (_dropTarget && square != _dropTarget)
+	{
+		_dropTarget->willNotDropBit(_dragBit);
+		//_dropTarget->setHighlighted(false);
+		_dropTarget = nullptr;
+	}
+	if (_oldHolder && square->canDropBitAtPoint(_dragBit, pos) && canBitMoveFromTo(*_dragBit, *_oldHolder, *square))
+	{
+		_dropTarget = square;
+		_dropTarget->setHighlighted(true);
+	}
 }
 
 void Chess::clearBoardHighlights() {
@@ -548,55 +479,3 @@ void Chess::clearBoardHighlights() {
 });}
 
 #pragma endregion
-
-#pragma region Bitboard Generation
-
-BitboardElement Chess::generateKnightBitboards(int square) {
-    BitboardElement result = 0LL;
-    int rank = square / 8;
-    int file = square % 8;
-
-    std::pair<int, int> knightOffsets[] = {
-                {-1, 2},    {1, 2},
-        {-2, 1},                    {2, 1},
-
-        {-2, -1},                   {2, -1},
-                {-1, -2},   {1, -2}
-    };
-
-    constexpr uint64_t oneBit = 1;
-    for (auto [dr, df] : knightOffsets) {
-        int r = rank + dr;
-        int f = file + df;
-        if (r >= 0 && r < 8 && f >= 0 && f < 8) {
-            result |= oneBit << (r * 8 + f);
-        }
-    }
-
-    return result;
-}
-
-BitboardElement Chess::generateKingBitboards(int square) {
-    BitboardElement result = 0LL;
-    int rank = square / 8;
-    int file = square % 8;
-
-    std::pair<int, int> kingOffsets[] = {
-        {-1, 1}, {0, 1}, {1, 1},
-        {-1, 0},         {1, 0},       
-        {-1, -1}, {0, -1}, {1, -1},
-    };
-
-    constexpr uint64_t oneBit = 1;
-    for (auto [dr, df] : kingOffsets) {
-        int r = rank + dr;
-        int f = file + df;
-        if (r >= 0 && r < 8 && f >= 0 && f < 8) {
-            result |= oneBit << (r * 8 + f);
-        }
-    }
-
-    return result;
-}
-
-#pragma endregion
\ No newline at end of file
@@ -2,40 +2,17 @@
 
 #include "Game.h"
 #include "Grid.h"
-#include "Bitboard.h"
-#include "MagicBitboards.h"
+#include "ChessPosition.h"
+#include "ChessSearch.h"
+
+#include <mutex>
 
 constexpr int pieceSize = 80;
-typedef uint64_t BitBoard;
-constexpr BitBoard BitZero = 1ULL;
-
-constexpr int WHITE = 0;
-constexpr int BLACK = 1;
-
-// rows (for bitboard stuff)
-constexpr uint64_t ROW_1 = 0x00000000000000FFULL;
-constexpr uint64_t ROW_2 = 0x000000000000FF00ULL;
-constexpr uint64_t ROW_3 = 0x0000000000FF0000ULL;
-constexpr uint64_t ROW_4 = 0x00000000FF000000ULL;
-constexpr uint64_t ROW_5 = 0x000000FF00000000ULL;
-constexpr uint64_t ROW_6 = 0x0000FF0000000000ULL;
-constexpr uint64_t ROW_7 = 0x00FF000000000000ULL;
-constexpr uint64_t ROW_8 = 0xFF00000000000000ULL;
-
-// cols
-constexpr uint64_t COL_1 = 0x0101010101010101ULL;
-constexpr uint64_t COL_2 = COL_1 << 1;
-constexpr uint64_t COL_3 = COL_1 << 2;
-constexpr uint64_t COL_4 = COL_1 << 3;
-constexpr uint64_t COL_5 = COL_1 << 4;
-constexpr uint64_t COL_6 = COL_1 << 5;
-constexpr uint64_t COL_7 = COL_1 << 6;
-constexpr uint64_t COL_8 = COL_1 << 7;
-
-// precompute for pawn movement
-constexpr uint64_t NOT_COL_1 = ~COL_1;
-constexpr uint64_t NOT_COL_8 = ~COL_8;
 
+//
+// the chess game, a UI adapter over ChessPosition (chesscore)
+// the grid and its bits are only the display, the rules all live in the position
+//
 class Chess : public Game
 {
 public:
@@ -46,10 +23,14 @@ public:
 
     bool canBitMoveFrom(Bit &bit, BitHolder &src) override;
     bool canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
-   // void bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
+    void bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
     bool actionForEmptyHolder(BitHolder &holder) override;
     void endTurn() override;
 
+    bool gameHasAI() override { return true; }
+    void updateAI() override;
+    bool isAIThinking() override { return _aiJob.valid() && !_aiFinished; }
+
     void stopGame() override;
 
     Player *checkForWinner() override;
@@ -58,6 +39,7 @@ public:
     std::string initialStateString() override;
     std::string stateString() override;
     void setStateString(const std::string &s) override;
+    uint64_t positionKey() override { return _position.key(); }
     char stateNotation(const char *state, int row, int col);
     int intNotation(const char *state, int row, int col);
 
@@ -75,40 +57,29 @@ private:
 
     Grid* _grid;
 
-    std::vector<BitMove> _moves;
-
-    // bitboards
-    BitboardElement _pawnBitboards[64];
-    BitboardElement _rookBitboards[64];
-    BitboardElement _knightBitboards[64];
-    BitboardElement _bishopBitboards[64];
-    BitboardElement _queenBitboards[64];
-    BitboardElement _kingBitboards[64];
-
-    // bitboard generation
-    void GenerateAllBitboards();
-    BitboardElement generatePawnBitboards(int square);
-    BitboardElement generateRookBitboards(int square);    
-    BitboardElement generateKnightBitboards(int square);
-    BitboardElement generateBishopBitboards(int square);
-    BitboardElement generateQueenBitboards(int square);
-    BitboardElement generateKingBitboards(int square);
+    ChessPosition _position;
+    MoveList _moves;
+    ChessSearch _search;
+
+    // the AI searches a copy of the position on a worker thread, updateAI picks up its progress and move
+    // on the frames it wakes the main loop for
+    void startAISearch();
+    void cancelAISearch();
+    void logAIProgress();
+    void logAIThreads();
+    std::future<BitMove> _aiJob;
+    std::atomic<bool> _aiCancel;
+    std::atomic<bool> _aiFinished;
+    std::mutex _aiProgressLock;
+    SearchInfo _aiProgress;
+    bool _aiProgressNew;
 
     // move generation
-    void addMoveIfValid(const char *state, std::vector<BitMove>& moves, int fromRow, int fromCol, int toRow, int toCol, ChessPiece piece);
-    std::vector<BitMove> generateAllMoves();
-
-    void addPawnMoves(std::vector<BitMove>& moves, BitboardElement pawnMoves, int shift);
-    void generateWhitePawnMoves(std::vector<BitMove>& moves, BitboardElement knightBoard, uint64_t emptySquares, uint64_t blackOccupancy);
-    void generateBlackPawnMoves(std::vector<BitMove>& moves, BitboardElement knightBoard, uint64_t emptySquares, uint64_t whiteOccupancy);
-
-    void generateKnightMoves(std::vector<BitMove>& moves, BitboardElement knightBoard, uint64_t availableSquares);
-    void generateRookMoves(std::vector<BitMove>& moves, BitboardElement rookBoard, uint64_t availableSquares, uint64_t blockedSquares);
-    void generateBishopMoves(std::vector<BitMove>& moves, BitboardElement bishopBoard, uint64_t availableSquares, uint64_t blockedSquares);
-    void generateQueenMoves(std::vector<BitMove>& moves, BitboardElement queenBoard, uint64_t availableSquares, uint64_t blockedSquares);
-    void generateKingMoves(std::vector<BitMove>& moves, BitboardElement kingBoard, uint64_t availableSquares);
+    void generateAllMoves();
+    void applyMoveToBoard(BitMove move);
 
     // test functions
     void TestStateNotation();
+    void TestMagicBitboards();
 
 };
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "ChessEval.h"
+
+#include <algorithm>
+
+// by how far the pawn has come, from its own side of the board
+static const int PassedPawnMidgame[8] = { 0, 5, 10, 15, 25, 40, 60, 0 };
+static const int PassedPawnEndgame[8] = { 0, 10, 20, 35, 60, 100, 150, 0 };
+static const int DoubledPawnMidgame = -10;
+static const int DoubledPawnEndgame = -20;
+static const int IsolatedPawnMidgame = -10;
+static const int IsolatedPawnEndgame = -15;
+
+// every square on or above / below a pawn, on its file
+static inline uint64_t northFill(uint64_t b) { b |= b << 8; b |= b << 16; return b | (b << 32); }
+static inline uint64_t southFill(uint64_t b) { b |= b >> 8; b |= b >> 16; return b | (b >> 32); }
+// the files either side of the given squares
+static inline uint64_t adjacentFiles(uint64_t b) { return ((b & NOT_COL_1) >> 1) | ((b & NOT_COL_8) << 1); }
+
+// doubled, isolated and passed pawns, added to midgame and endgame from white's point of view
+// all worked out a whole bitboard at a time, only passed pawns (there are rarely many) are looked at one by one
+static void evaluatePawns(const ChessPosition& position, int& midgame, int& endgame)
+{
+    uint64_t whitePawns = position.pieces(WHITE, Pawn);
+    uint64_t blackPawns = position.pieces(BLACK, Pawn);
+
+    // the squares in front of each side's pawns, and the ones their neighbours could stop a pawn on
+    uint64_t whiteFront = northFill(whitePawns << 8);
+    uint64_t blackFront = southFill(blackPawns >> 8);
+
+    for (int color = WHITE; color <= BLACK; color++) {
+        int sign = color == WHITE ? 1 : -1;
+        uint64_t pawns = color == WHITE ? whitePawns : blackPawns;
+        uint64_t front = color == WHITE ? whiteFront : blackFront;
+        uint64_t enemyFront = color == WHITE ? blackFront : whiteFront;
+
+        // a pawn with another of ours in front of it on the same file
+        int doubled = countOnes(pawns & front);
+        midgame += sign * DoubledPawnMidgame * doubled;
+        endgame += sign * DoubledPawnEndgame * doubled;
+
+        int isolated = countOnes(pawns & ~adjacentFiles(northFill(pawns) | southFill(pawns)));
+        midgame += sign * IsolatedPawnMidgame * isolated;
+        endgame += sign * IsolatedPawnEndgame * isolated;
+
+        // passed: no enemy pawn ahead of it on its own file or either side
+        uint64_t passed = pawns & ~(enemyFront | adjacentFiles(enemyFront));
+        BitboardElement(passed).forEachBit([&] (int square) {
+            int advance = color == WHITE ? square / 8 : 7 - square / 8;
+            midgame += sign * PassedPawnMidgame[advance];
+            endgame += sign * PassedPawnEndgame[advance];
+        });
+    }
+}
+
+int evaluate(const ChessPosition& position)
+{
+    // from white's point of view until the end
+    int midgame = position.midgameScore();
+    int endgame = position.endgameScore();
+    evaluatePawns(position, midgame, endgame);
+
+    int phase = position.gamePhase() < MaxPhase ? position.gamePhase() : MaxPhase;
+    int score = (midgame * phase + endgame * (MaxPhase - phase)) / MaxPhase;
+
+    return position.sideToMove() == WHITE ? score : -score;
+}
+
+int staticExchange(const ChessPosition& position, BitMove move)
+{
+    if (move.isCastle()) {
+        return 0;
+    }
+
+    int from = move.from();
+    int to = move.to();
+    int side = position.sideToMove();
+    uint64_t occupied = position.occupancy() ^ (1ULL << from);
+
+    // gain[d] is what the side capturing at depth d is up if the exchange stops right after
+    int gain[32];
+    int depth = 0;
+    ChessPiece attacker = position.pieceAt(from);
+
+    if (move.isEnPassant()) {
+        occupied ^= 1ULL << (side == WHITE ? to - 8 : to + 8);
+        gain[0] = PieceValues[Pawn];
+    } else {
+        gain[0] = PieceValues[position.pieceAt(to)];
+    }
+    if (move.isPromotion()) {
+        attacker = move.promotionPiece();
+        gain[0] += PieceValues[attacker] - PieceValues[Pawn];
+    }
+
+    uint64_t diagonals = position.pieces(WHITE, Bishop) | position.pieces(BLACK, Bishop)
+                       | position.pieces(WHITE, Queen) | position.pieces(BLACK, Queen);
+    uint64_t straights = position.pieces(WHITE, Rook) | position.pieces(BLACK, Rook)
+                       | position.pieces(WHITE, Queen) | position.pieces(BLACK, Queen);
+    uint64_t knights = position.pieces(WHITE, Knight) | position.pieces(BLACK, Knight);
+    uint64_t kings = position.pieces(WHITE, King) | position.pieces(BLACK, King);
+    // both colors at once, a pawn attacks the square if a pawn of the other color there would attack it back
+    uint64_t attackers = ((PawnAttacks[BLACK][to] & position.pieces(WHITE, Pawn))
+                        | (PawnAttacks[WHITE][to] & position.pieces(BLACK, Pawn))
+                        | (KnightAttacks[to] & knights)
+                        | (KingAttacks[to] & kings)
+                        | (getBishopAttacks(to, occupied) & diagonals)
+                        | (getRookAttacks(to, occupied) & straights)) & occupied;
+
+    while (depth < 31) {
+        side ^= 1;
+        uint64_t ours = attackers & position.occupancy(side);
+        if (!ours) {
+            break;
+        }
+
+        // the cheapest piece this side can recapture with
+        ChessPiece piece = Pawn;
+        uint64_t candidates = 0;
+        for (; piece <= King; piece = ChessPiece(piece + 1)) {
+            candidates = ours & position.pieces(side, piece);
+            if (candidates) {
+                break;
+            }
+        }
+        // the king can only take last, when nothing could take it back
+        if (piece == King && (attackers & position.occupancy(side ^ 1))) {
+            break;
+        }
+
+        depth++;
+        gain[depth] = PieceValues[attacker] - gain[depth - 1];
+        // this side is behind whether it takes or not, so it doesn't take and the exchange is over
+        if (std::max(-gain[depth - 1], gain[depth]) < 0) {
+            depth--;
+            break;
+        }
+
+        occupied ^= candidates & (0 - candidates); // the lowest one
+        attacker = piece;
+
+        // whatever was behind it on the same line can now see the square
+        if (piece == Pawn || piece == Bishop || piece == Queen) {
+            attackers |= getBishopAttacks(to, occupied) & diagonals;
+        }
+        if (piece == Rook || piece == Queen) {
+            attackers |= getRookAttacks(to, occupied) & straights;
+        }
+        attackers &= occupied;
+    }
+
+    // work back up, each side picks the better of capturing or standing pat
+    while (depth > 0) {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+        depth--;
+    }
+    return gain[0];
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ChessPosition.h"
+#include "PieceSquareTables.h"
+
+//
+// static evaluation for the chess search: material and piece-square tables tapered from middlegame to
+// endgame by the game phase, plus a pawn structure term
+// the material and piece-square part is kept up to date by ChessPosition, so only the pawns are looked at here
+// scores are in centipawns from the side to move's point of view
+//
+
+// what the search orders and trades by, the middlegame values
+inline constexpr const int (&PieceValues)[7] = MidgameValues;
+
+int evaluate(const ChessPosition& position);
+
+// static exchange evaluation: what the side making move comes out with in material if both sides
+// keep recapturing on the target square with their cheapest piece, and either can stop when it suits them
+// sliders lined up behind a piece that takes join in once it has gone
+int staticExchange(const ChessPosition& position, BitMove move);
@@ -0,0 +1,707 @@
+#include "ChessPosition.h"
+#include "PieceSquareTables.h"
+#include <cctype>
+#include <sstream>
+
+// castling rights that are lost when a piece moves from or to one of these squares
+static int castlingRightsLost(int square) {
+    switch (square) {
+        case 0:  return WhiteQueenside;
+        case 4:  return WhiteKingside | WhiteQueenside;
+        case 7:  return WhiteKingside;
+        case 56: return BlackQueenside;
+        case 60: return BlackKingside | BlackQueenside;
+        case 63: return BlackKingside;
+    }
+    return NoCastling;
+}
+
+static ChessPiece pieceFromNotation(char c) {
+    switch (toupper(c)) {
+        case 'P': return Pawn;
+        case 'N': return Knight;
+        case 'B': return Bishop;
+        case 'R': return Rook;
+        case 'Q': return Queen;
+        case 'K': return King;
+    }
+    return NoPiece;
+}
+
+std::string squareName(int square)
+{
+    if (square < 0 || square > 63) return "-";
+    return std::string(1, char('a' + square % 8)) + char('1' + square / 8);
+}
+
+std::string moveToUCI(BitMove move)
+{
+    std::string name = squareName(move.from()) + squareName(move.to());
+    if (move.isPromotion()) {
+        name += "nbrq"[move.promotionPiece() - Knight];
+    }
+    return name;
+}
+
+ChessPosition::ChessPosition()
+{
+    initMagicBitboards();
+    clear();
+}
+
+void ChessPosition::clear()
+{
+    for (int color = 0; color < 2; color++) {
+        for (int piece = 0; piece < 7; piece++) {
+            _pieces[color][piece] = 0;
+        }
+        _occupancy[color] = 0;
+    }
+    for (int square = 0; square < 64; square++) {
+        _board[square] = NoPiece;
+    }
+    _sideToMove = WHITE;
+    _castling = NoCastling;
+    _enPassant = NoSquare;
+    _halfmoveClock = 0;
+    _fullmoveNumber = 1;
+    _key = 0;
+    _midgame = 0;
+    _endgame = 0;
+    _phase = 0;
+    _undoStack.clear();
+}
+
+bool ChessPosition::setFEN(const std::string& fen)
+{
+    // FEN is a space delimited string with 6 fields
+    // 1: piece placement (from white's perspective)
+    // 2: active color (w or b)
+    // 3: castling availability (KQkq or -)
+    // 4: en passant target square (in algebraic notation, or -)
+    // 5: halfmove clock (number of halfmoves since the last capture or pawn advance)
+    // 6: fullmove number
+    std::istringstream fields(fen);
+    std::string placement, active = "w", castling = "-", enPassant = "-";
+    int halfmove = 0, fullmove = 1;
+    fields >> placement >> active >> castling >> enPassant >> halfmove >> fullmove;
+
+    clear();
+
+    // every rank has to add up to exactly 8 squares, and there have to be exactly 8 ranks
+    int row = 7;
+    int col = 0;
+    for (char c : placement) {
+        if (c == '/') { // move down a row
+            if (col != 8 || row == 0) {
+                clear();
+                return false;
+            }
+            row--;
+            col = 0;
+        } else if (c >= '1' && c <= '8') {
+            col += c - '0';
+            if (col > 8) {
+                clear();
+                return false;
+            }
+        } else {
+            ChessPiece piece = pieceFromNotation(c);
+            if (piece == NoPiece || col > 7) {
+                clear();
+                return false;
+            }
+            putPiece(row * 8 + col, isupper(c) ? WHITE : BLACK, piece);
+            col++;
+        }
+    }
+
+    // move generation needs one king a side to work out checks and pins
+    if (row != 0 || col != 8 || countOnes(pieces(WHITE, King)) != 1 || countOnes(pieces(BLACK, King)) != 1) {
+        clear();
+        return false;
+    }
+
+    _sideToMove = (active == "b") ? BLACK : WHITE;
+
+    for (char c : castling) {
+        switch (c) {
+            case 'K': _castling |= WhiteKingside; break;
+            case 'Q': _castling |= WhiteQueenside; break;
+            case 'k': _castling |= BlackKingside; break;
+            case 'q': _castling |= BlackQueenside; break;
+        }
+    }
+    // castling moves the king from e1/e8 and the rook from its corner, drop any right those pieces aren't there for
+    auto hasPiece = [&] (int square, int color, ChessPiece piece) {
+        return pieceAt(square) == piece && colorAt(square) == color;
+    };
+    if (!hasPiece(4, WHITE, King)) _castling &= ~(WhiteKingside | WhiteQueenside);
+    if (!hasPiece(7, WHITE, Rook)) _castling &= ~WhiteKingside;
+    if (!hasPiece(0, WHITE, Rook)) _castling &= ~WhiteQueenside;
+    if (!hasPiece(60, BLACK, King)) _castling &= ~(BlackKingside | BlackQueenside);
+    if (!hasPiece(63, BLACK, Rook)) _castling &= ~BlackKingside;
+    if (!hasPiece(56, BLACK, Rook)) _castling &= ~BlackQueenside;
+
+    // the en passant square only counts if a pawn of the side that just moved really could have
+    // double pushed past it, anything else would let the capture take the wrong pawn, so it reads as -
+    if (enPassant.size() == 2 && enPassant[0] >= 'a' && enPassant[0] <= 'h' && enPassant[1] >= '1' && enPassant[1] <= '8') {
+        int square = (enPassant[1] - '1') * 8 + (enPassant[0] - 'a');
+        int them = _sideToMove ^ 1;
+        int pushed = _sideToMove == WHITE ? square - 8 : square + 8;
+        int origin = _sideToMove == WHITE ? square + 8 : square - 8;
+        bool rightRank = (square >> 3) == (_sideToMove == WHITE ? 5 : 2);
+        if (rightRank && pieceAt(pushed) == Pawn && colorAt(pushed) == them
+            && pieceAt(square) == NoPiece && pieceAt(origin) == NoPiece) {
+            _enPassant = square;
+        }
+    }
+
+    _halfmoveClock = halfmove;
+    _fullmoveNumber = fullmove;
+    _key = computeKey();
+    return true;
+}
+
+std::string ChessPosition::toFEN() const
+{
+    const char* notation = "0pnbrqk";
+    std::string fen;
+    for (int row = 7; row >= 0; row--) {
+        int empty = 0;
+        for (int col = 0; col < 8; col++) {
+            int square = row * 8 + col;
+            ChessPiece piece = pieceAt(square);
+            if (piece == NoPiece) {
+                empty++;
+                continue;
+            }
+            if (empty) {
+                fen += char('0' + empty);
+                empty = 0;
+            }
+            char c = notation[piece];
+            fen += colorAt(square) == WHITE ? char(toupper(c)) : c;
+        }
+        if (empty) {
+            fen += char('0' + empty);
+        }
+        if (row > 0) {
+            fen += '/';
+        }
+    }
+
+    fen += _sideToMove == WHITE ? " w " : " b ";
+
+    std::string castling;
+    if (_castling & WhiteKingside) castling += 'K';
+    if (_castling & WhiteQueenside) castling += 'Q';
+    if (_castling & BlackKingside) castling += 'k';
+    if (_castling & BlackQueenside) castling += 'q';
+    fen += castling.empty() ? "-" : castling;
+
+    fen += ' ';
+    fen += squareName(_enPassant);
+    fen += ' ';
+    fen += std::to_string(_halfmoveClock);
+    fen += ' ';
+    fen += std::to_string(_fullmoveNumber);
+    return fen;
+}
+
+void ChessPosition::setSideToMove(int color)
+{
+    if (color != _sideToMove) {
+        _sideToMove = color;
+        _key ^= Zobrist.sideToMove;
+    }
+}
+
+uint64_t ChessPosition::computeKey() const
+{
+    uint64_t key = 0;
+    for (int square = 0; square < 64; square++) {
+        if (pieceAt(square) != NoPiece) {
+            key ^= Zobrist.pieces[colorAt(square)][pieceAt(square)][square];
+        }
+    }
+    key ^= Zobrist.castling[_castling];
+    if (_enPassant != NoSquare) {
+        key ^= Zobrist.enPassantFile[_enPassant % 8];
+    }
+    if (_sideToMove == BLACK) {
+        key ^= Zobrist.sideToMove;
+    }
+    return key;
+}
+
+void ChessPosition::computeScores(int& midgame, int& endgame, int& phase) const
+{
+    midgame = endgame = phase = 0;
+    for (int square = 0; square < 64; square++) {
+        ChessPiece piece = pieceAt(square);
+        if (piece != NoPiece) {
+            midgame += PieceSquare.midgame[colorAt(square)][piece][square];
+            endgame += PieceSquare.endgame[colorAt(square)][piece][square];
+            phase += PhaseWeights[piece];
+        }
+    }
+}
+
+bool ChessPosition::isRepetition() const
+{
+    // only positions with the same side to move, and nothing before the last irreversible move
+    int played = (int)_undoStack.size();
+    int limit = _halfmoveClock < played ? _halfmoveClock : played;
+    for (int back = 2; back <= limit; back += 2) {
+        if (_undoStack[played - back].key == _key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int ChessPosition::repetitionCount() const
+{
+    int played = (int)_undoStack.size();
+    int limit = _halfmoveClock < played ? _halfmoveClock : played;
+    int count = 0;
+    for (int back = 2; back <= limit; back += 2) {
+        if (_undoStack[played - back].key == _key) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool ChessPosition::hasInsufficientMaterial() const
+{
+    for (int color = 0; color < 2; color++) {
+        if (_pieces[color][Pawn] | _pieces[color][Rook] | _pieces[color][Queen]) {
+            return false;
+        }
+    }
+    // bare kings, or a single knight or bishop on the board
+    uint64_t minors = _pieces[WHITE][Knight] | _pieces[WHITE][Bishop] | _pieces[BLACK][Knight] | _pieces[BLACK][Bishop];
+    return countOnes(minors) <= 1;
+}
+
+void ChessPosition::putPiece(int square, int color, ChessPiece piece)
+{
+    uint64_t bit = 1ULL << square;
+    _pieces[color][piece] |= bit;
+    _occupancy[color] |= bit;
+    _board[square] = piece | (color ? 128 : 0);
+    _key ^= Zobrist.pieces[color][piece][square];
+    _midgame += PieceSquare.midgame[color][piece][square];
+    _endgame += PieceSquare.endgame[color][piece][square];
+    _phase += PhaseWeights[piece];
+}
+
+void ChessPosition::removePiece(int square)
+{
+    uint64_t bit = 1ULL << square;
+    int color = colorAt(square);
+    ChessPiece piece = pieceAt(square);
+    _pieces[color][piece] &= ~bit;
+    _occupancy[color] &= ~bit;
+    _board[square] = NoPiece;
+    _key ^= Zobrist.pieces[color][piece][square];
+    _midgame -= PieceSquare.midgame[color][piece][square];
+    _endgame -= PieceSquare.endgame[color][piece][square];
+    _phase -= PhaseWeights[piece];
+}
+
+void ChessPosition::movePiece(int from, int to)
+{
+    int color = colorAt(from);
+    ChessPiece piece = pieceAt(from);
+    removePiece(from);
+    putPiece(to, color, piece);
+}
+
+int ChessPosition::kingSquare(int color) const
+{
+    uint64_t king = _pieces[color][King];
+    return king ? getFirstBit(king) : NoSquare;
+}
+
+bool ChessPosition::isSquareAttacked(int square, int byColor) const
+{
+    if (square == NoSquare) return false;
+
+    uint64_t occupied = occupancy();
+    const uint64_t* them = _pieces[byColor];
+
+    // a pawn attacks this square if a pawn of the other color standing here would attack it back
+    if (PawnAttacks[byColor ^ 1][square] & them[Pawn]) return true;
+    if (KnightAttacks[square] & them[Knight]) return true;
+    if (KingAttacks[square] & them[King]) return true;
+    if (getBishopAttacks(square, occupied) & (them[Bishop] | them[Queen])) return true;
+    if (getRookAttacks(square, occupied) & (them[Rook] | them[Queen])) return true;
+    return false;
+}
+
+#pragma region MOVE GENERATION
+
+// every piece of byColor attacking square, with the given occupancy
+uint64_t ChessPosition::attackersTo(int square, int byColor, uint64_t occupied) const
+{
+    const uint64_t* them = _pieces[byColor];
+    return (PawnAttacks[byColor ^ 1][square] & them[Pawn])
+         | (KnightAttacks[square] & them[Knight])
+         | (KingAttacks[square] & them[King])
+         | (getBishopAttacks(square, occupied) & (them[Bishop] | them[Queen]))
+         | (getRookAttacks(square, occupied) & (them[Rook] | them[Queen]));
+}
+
+// every square byColor attacks, with the given occupancy
+uint64_t ChessPosition::attackedSquares(int byColor, uint64_t occupied) const
+{
+    const uint64_t* them = _pieces[byColor];
+    uint64_t attacked = byColor == WHITE ? WHITE_PAWN_ATTACKS(them[Pawn]) : BLACK_PAWN_ATTACKS(them[Pawn]);
+    BitboardElement(them[Knight]).forEachBit([&] (int square) { attacked |= KnightAttacks[square]; });
+    BitboardElement(them[Bishop] | them[Queen]).forEachBit([&] (int square) { attacked |= getBishopAttacks(square, occupied); });
+    BitboardElement(them[Rook] | them[Queen]).forEachBit([&] (int square) { attacked |= getRookAttacks(square, occupied); });
+    BitboardElement(them[King]).forEachBit([&] (int square) { attacked |= KingAttacks[square]; });
+    return attacked;
+}
+
+// our pieces that are the only thing between our king and an enemy slider
+uint64_t ChessPosition::pinnedPieces(int color, int king) const
+{
+    const uint64_t* them = _pieces[color ^ 1];
+    uint64_t occupied = occupancy();
+
+    // sliders that would see the king through our pieces
+    uint64_t snipers = (getRookAttacks(king, _occupancy[color ^ 1]) & (them[Rook] | them[Queen]))
+                     | (getBishopAttacks(king, _occupancy[color ^ 1]) & (them[Bishop] | them[Queen]));
+    uint64_t pinned = 0;
+    BitboardElement(snipers).forEachBit([&] (int sniper) {
+        uint64_t blockers = BetweenSquares[king][sniper] & occupied;
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & _occupancy[color])) {
+            pinned |= blockers;
+        }
+    });
+    return pinned;
+}
+
+// legal moves straight from the masks, nothing is made and taken back to test it:
+// - the king can't step onto a square the enemy attacks (worked out with our king off the board,
+//   so it can't hide behind itself from a slider)
+// - with one checker everything else has to take it or block it, with two only the king can move
+// - a pinned piece can only move along the line through the king and its pinner
+void ChessPosition::generateLegalMoves(MoveList& moves, MoveGenType type, uint64_t fromMask) const
+{
+    int us = _sideToMove;
+    int them = us ^ 1;
+    int king = kingSquare(us);
+    uint64_t kingBit = 1ULL << king;
+    uint64_t occupied = occupancy();
+    uint64_t ownPieces = _occupancy[us];
+    uint64_t enemies = _occupancy[them];
+
+    // the squares this type of move can land on, before legality narrows them down
+    uint64_t typeMask = type == GenTactical ? enemies : (type == GenQuiet ? ~occupied : ~ownPieces);
+
+    uint64_t checkers = attackersTo(king, them, occupied);
+
+    // the enemy attack map is the expensive part, and only the king needs it
+    uint64_t kingDanger = 0;
+    if (fromMask & kingBit) {
+        kingDanger = attackedSquares(them, occupied ^ kingBit);
+        BitboardElement(KingAttacks[king] & typeMask & ~ownPieces & ~kingDanger).forEachBit([&] (int toSquare) {
+            moves.add(king, toSquare, ((1ULL << toSquare) & enemies) ? MoveCapture : MoveQuiet);
+        });
+    }
+
+    if (checkers & (checkers - 1)) {
+        return; // double check, only the king can do anything about it
+    }
+
+    uint64_t targetMask = ~ownPieces;
+    if (checkers) {
+        int checker = getFirstBit(checkers);
+        targetMask &= checkers | BetweenSquares[king][checker];
+    } else if (type != GenTactical && (fromMask & kingBit)) {
+        generateCastleMoves(moves, kingDanger);
+    }
+
+    uint64_t pinned = pinnedPieces(us, king);
+    uint64_t pawns = _pieces[us][Pawn] & fromMask;
+
+    // pawns sort out tactical and quiet themselves, a push to the last row is a promotion
+    generatePawnMoves(moves, pawns & ~pinned, targetMask, type);
+    BitboardElement(pawns & pinned).forEachBit([&] (int fromSquare) {
+        generatePawnMoves(moves, 1ULL << fromSquare, targetMask & LineSquares[king][fromSquare], type);
+    });
+    if (type != GenQuiet) {
+        generateEnPassantMoves(moves, pawns, king, checkers, targetMask);
+    }
+
+    targetMask &= typeMask;
+    for (int piece = Knight; piece <= Queen; piece++) {
+        BitboardElement(_pieces[us][piece] & fromMask).forEachBit([&] (int fromSquare) {
+            uint64_t targets = pieceAttacks(ChessPiece(piece), fromSquare, occupied) & targetMask;
+            if (pinned & (1ULL << fromSquare)) {
+                targets &= LineSquares[king][fromSquare];
+            }
+            BitboardElement(targets).forEachBit([&] (int toSquare) {
+                moves.add(fromSquare, toSquare, ((1ULL << toSquare) & enemies) ? MoveCapture : MoveQuiet);
+            });
+        });
+    }
+}
+
+// only the piece on the from square is generated, so this is a lot cheaper than a full list
+bool ChessPosition::isLegalMove(BitMove move) const
+{
+    if (move.isNull() || !(_occupancy[_sideToMove] & (1ULL << move.from()))) {
+        return false;
+    }
+    MoveList moves;
+    generateLegalMoves(moves, GenAll, 1ULL << move.from());
+    for (auto legal : moves) {
+        if (legal == move) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t ChessPosition::pieceAttacks(ChessPiece piece, int square, uint64_t occupied) const
+{
+    switch (piece) {
+        case Knight: return KnightAttacks[square];
+        case Bishop: return getBishopAttacks(square, occupied);
+        case Rook:   return getRookAttacks(square, occupied);
+        case Queen:  return getQueenAttacks(square, occupied);
+        case King:   return KingAttacks[square];
+        default:     return 0;
+    }
+}
+
+void ChessPosition::addPawnMoves(MoveList& moves, uint64_t pawnMoves, int shift, int flags) const
+{
+    BitboardElement(pawnMoves).forEachBit([&] (int toSquare) {
+        int fromSquare = toSquare + shift;
+        if ((1ULL << toSquare) & (ROW_1 | ROW_8)) {
+            for (int promotion = 3; promotion >= 0; promotion--) { // queen first
+                moves.add(fromSquare, toSquare, flags | MovePromotion | promotion);
+            }
+        } else {
+            moves.add(fromSquare, toSquare, flags);
+        }
+    });
+}
+
+// pushes and captures for the given pawns, landing only on targetMask
+// promotions count as tactical whether they capture or not
+void ChessPosition::generatePawnMoves(MoveList& moves, uint64_t pawns, uint64_t targetMask, MoveGenType type) const
+{
+    uint64_t emptySquares = ~occupancy();
+    uint64_t enemies = type == GenQuiet ? 0 : _occupancy[_sideToMove ^ 1] & targetMask;
+    uint64_t pushMask = targetMask;
+    if (type == GenTactical) {
+        pushMask &= ROW_1 | ROW_8;
+    } else if (type == GenQuiet) {
+        pushMask &= ~(ROW_1 | ROW_8);
+    }
+
+    // a double push only needs the square in between to be empty, the landing square has to be on the mask
+    if (_sideToMove == WHITE) {
+        uint64_t singleMoves = (pawns << 8) & emptySquares; // shift 8 moves up a whole row
+        addPawnMoves(moves, singleMoves & pushMask, -8, MoveQuiet);
+        if (type != GenTactical) {
+            addPawnMoves(moves, ((singleMoves & ROW_3) << 8) & emptySquares & targetMask, -16, MoveDoublePush);
+        }
+        addPawnMoves(moves, ((pawns & NOT_COL_1) << 7) & enemies, -7, MoveCapture); // up and left
+        addPawnMoves(moves, ((pawns & NOT_COL_8) << 9) & enemies, -9, MoveCapture); // up and right
+    } else {
+        uint64_t singleMoves = (pawns >> 8) & emptySquares; // shift 8 moves down a whole row
+        addPawnMoves(moves, singleMoves & pushMask, 8, MoveQuiet);
+        if (type != GenTactical) {
+            addPawnMoves(moves, ((singleMoves & ROW_6) >> 8) & emptySquares & targetMask, 16, MoveDoublePush);
+        }
+        addPawnMoves(moves, ((pawns & NOT_COL_1) >> 9) & enemies, 9, MoveCapture); // down and left
+        addPawnMoves(moves, ((pawns & NOT_COL_8) >> 7) & enemies, 7, MoveCapture); // down and right
+    }
+}
+
+// en passant takes a pawn off a square the move doesn't land on, which the masks can't see,
+// so each one is checked by hand against the sliders on what the board will look like afterwards
+void ChessPosition::generateEnPassantMoves(MoveList& moves, uint64_t pawns, int king, uint64_t checkers, uint64_t targetMask) const
+{
+    if (_enPassant == NoSquare) return;
+
+    int us = _sideToMove;
+    int capturedSquare = _enPassant + (us == WHITE ? -8 : 8);
+    // with a checker the capture has to take it (it's the pawn that just moved) or block it
+    if (checkers && !(checkers & (1ULL << capturedSquare)) && !(targetMask & (1ULL << _enPassant))) return;
+
+    uint64_t target = 1ULL << _enPassant;
+    uint64_t attackers = PawnAttacks[us ^ 1][_enPassant] & pawns;
+    const uint64_t* them = _pieces[us ^ 1];
+    BitboardElement(attackers).forEachBit([&] (int fromSquare) {
+        uint64_t after = (occupancy() ^ (1ULL << fromSquare) ^ (1ULL << capturedSquare)) | target;
+        if (getRookAttacks(king, after) & (them[Rook] | them[Queen])) return;
+        if (getBishopAttacks(king, after) & (them[Bishop] | them[Queen])) return;
+        moves.add(fromSquare, _enPassant, MoveEnPassant);
+    });
+}
+
+void ChessPosition::generateCastleMoves(MoveList& moves, uint64_t kingDanger) const
+{
+    int us = _sideToMove;
+    int kingside = us == WHITE ? WhiteKingside : BlackKingside;
+    int queenside = us == WHITE ? WhiteQueenside : BlackQueenside;
+    if (!(_castling & (kingside | queenside))) return;
+
+    // only called when we're not in check, the squares between king and rook must be empty,
+    // and the king can't pass through an attack
+    int king = us == WHITE ? 4 : 60;
+    uint64_t occupied = occupancy();
+    if ((_castling & kingside) && !(occupied & (3ULL << (king + 1))) && !(kingDanger & (3ULL << (king + 1)))) {
+        moves.add(king, king + 2, MoveKingCastle);
+    }
+    if ((_castling & queenside) && !(occupied & (7ULL << (king - 3))) && !(kingDanger & (3ULL << (king - 2)))) {
+        moves.add(king, king - 2, MoveQueenCastle);
+    }
+}
+
+#pragma endregion
+
+#pragma region MAKE UNMAKE
+
+void ChessPosition::makeMove(BitMove move)
+{
+    int us = _sideToMove;
+    int from = move.from();
+    int to = move.to();
+    int captureSquare = move.isEnPassant() ? (us == WHITE ? to - 8 : to + 8) : to; // ep captures the pawn behind the target
+
+    UndoInfo undo;
+    undo.captured = move.isCapture() ? pieceAt(captureSquare) : NoPiece;
+    undo.castling = _castling;
+    undo.enPassant = _enPassant;
+    undo.halfmoveClock = _halfmoveClock;
+    undo.key = _key;
+    _undoStack.push_back(undo);
+
+    _halfmoveClock++;
+    if (pieceAt(from) == Pawn || move.isCapture()) {
+        _halfmoveClock = 0;
+    }
+
+    if (move.isCapture()) {
+        removePiece(captureSquare);
+    }
+
+    movePiece(from, to);
+
+    if (move.isPromotion()) {
+        removePiece(to);
+        putPiece(to, us, move.promotionPiece());
+    } else if (move.isCastle()) {
+        int base = to & 56;
+        if (move.flags() == MoveKingCastle) {
+            movePiece(base + 7, base + 5);
+        } else {
+            movePiece(base, base + 3);
+        }
+    }
+
+    if (_enPassant != NoSquare) {
+        _key ^= Zobrist.enPassantFile[_enPassant % 8];
+    }
+    _enPassant = move.flags() == MoveDoublePush ? (from + to) / 2 : NoSquare;
+    if (_enPassant != NoSquare) {
+        _key ^= Zobrist.enPassantFile[_enPassant % 8];
+    }
+
+    _key ^= Zobrist.castling[_castling];
+    _castling &= ~(castlingRightsLost(from) | castlingRightsLost(to));
+    _key ^= Zobrist.castling[_castling];
+
+    if (us == BLACK) {
+        _fullmoveNumber++;
+    }
+    _sideToMove = us ^ 1;
+    _key ^= Zobrist.sideToMove;
+}
+
+void ChessPosition::unmakeMove(BitMove move)
+{
+    if (_undoStack.empty()) return;
+
+    UndoInfo undo = _undoStack.back();
+    _undoStack.pop_back();
+
+    _sideToMove ^= 1;
+    int us = _sideToMove;
+    int from = move.from();
+    int to = move.to();
+
+    if (us == BLACK) {
+        _fullmoveNumber--;
+    }
+
+    if (move.isPromotion()) {
+        removePiece(to);
+        putPiece(to, us, Pawn);
+    } else if (move.isCastle()) {
+        int base = to & 56;
+        if (move.flags() == MoveKingCastle) {
+            movePiece(base + 5, base + 7);
+        } else {
+            movePiece(base + 3, base);
+        }
+    }
+
+    movePiece(to, from);
+
+    if (undo.captured != NoPiece) {
+        int captureSquare = move.isEnPassant() ? (us == WHITE ? to - 8 : to + 8) : to;
+        putPiece(captureSquare, us ^ 1, ChessPiece(undo.captured));
+    }
+
+    _castling = undo.castling;
+    _enPassant = undo.enPassant;
+    _halfmoveClock = undo.halfmoveClock;
+    _key = undo.key;
+}
+
+void ChessPosition::makeNullMove()
+{
+    UndoInfo undo;
+    undo.captured = NoPiece;
+    undo.castling = _castling;
+    undo.enPassant = _enPassant;
+    undo.halfmoveClock = _halfmoveClock;
+    undo.key = _key;
+    _undoStack.push_back(undo);
+
+    if (_enPassant != NoSquare) {
+        _key ^= Zobrist.enPassantFile[_enPassant % 8];
+        _enPassant = NoSquare;
+    }
+    // positions on either side of a null move can't repeat each other
+    _halfmoveClock = 0;
+    _sideToMove ^= 1;
+    _key ^= Zobrist.sideToMove;
+}
+
+void ChessPosition::unmakeNullMove()
+{
+    if (_undoStack.empty()) return;
+
+    UndoInfo undo = _undoStack.back();
+    _undoStack.pop_back();
+
+    _sideToMove ^= 1;
+    _enPassant = undo.enPassant;
+    _halfmoveClock = undo.halfmoveClock;
+    _key = undo.key;
+}
+
+#pragma endregion
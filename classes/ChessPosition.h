@@ -0,0 +1,145 @@
+#pragma once
+
+#include "Bitboard.h"
+#include "MagicBitboards.h"
+#include "Zobrist.h"
+
+#include <string>
+#include <vector>
+
+//
+// headless chess position, everything the engine needs to know about a board
+// no ImGui, textures, or Logger in here so it can be linked on its own (the chesscore target)
+//
+
+constexpr const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// castling rights bits
+enum CastlingRights
+{
+    NoCastling      = 0,
+    WhiteKingside   = 1,
+    WhiteQueenside  = 2,
+    BlackKingside   = 4,
+    BlackQueenside  = 8,
+    AllCastling     = 15
+};
+
+constexpr int NoSquare = -1;
+
+// which legal moves to generate, so the search can ask for captures first and quiet moves only if it needs them
+// tactical is captures (en passant included) and every promotion, quiet is everything else (castling included)
+enum MoveGenType
+{
+    GenAll,
+    GenTactical,
+    GenQuiet
+};
+
+// long algebraic names, the way UCI and perft divide print them (e2e4, e7e8q)
+std::string squareName(int square);
+std::string moveToUCI(BitMove move);
+
+class ChessPosition
+{
+public:
+    ChessPosition();
+
+    // board setup
+    // setFEN accepts all 6 fields, anything missing after the placement gets the usual default
+    bool setFEN(const std::string& fen);
+    // all 6 fields, the way setFEN reads them back
+    std::string toFEN() const;
+    void clear();
+    void putPiece(int square, int color, ChessPiece piece);
+    void setSideToMove(int color);
+
+    // board queries
+    uint64_t pieces(int color, ChessPiece piece) const { return _pieces[color][piece]; }
+    uint64_t occupancy(int color) const { return _occupancy[color]; }
+    uint64_t occupancy() const { return _occupancy[WHITE] | _occupancy[BLACK]; }
+    // the board uses the same tags as the Bit game tags: piece, +128 for black
+    ChessPiece pieceAt(int square) const { return ChessPiece(_board[square] & 127); }
+    int colorAt(int square) const { return _board[square] >> 7; }
+    int kingSquare(int color) const;
+
+    int sideToMove() const { return _sideToMove; }
+    int castlingRights() const { return _castling; }
+    int enPassantSquare() const { return _enPassant; }
+    int halfmoveClock() const { return _halfmoveClock; }
+    int fullmoveNumber() const { return _fullmoveNumber; }
+
+    // zobrist key, kept up to date by every board change
+    uint64_t key() const { return _key; }
+    uint64_t computeKey() const;
+
+    // material plus piece-square totals (white minus black) and the game phase, kept up to date the same way
+    int midgameScore() const { return _midgame; }
+    int endgameScore() const { return _endgame; }
+    int gamePhase() const { return _phase; }
+    // the same three added up from scratch, to check the running ones against
+    void computeScores(int& midgame, int& endgame, int& phase) const;
+    // has this position come up before since the last capture or pawn move
+    bool isRepetition() const;
+    // how many times it has, three in all (two before this one) is a draw
+    int repetitionCount() const;
+    // neither side has enough left to ever mate
+    bool hasInsufficientMaterial() const;
+
+    // attacks
+    bool isSquareAttacked(int square, int byColor) const;
+    bool inCheck() const { return isSquareAttacked(kingSquare(_sideToMove), _sideToMove ^ 1); }
+
+    // move generation and make/unmake
+    // generation is fully legal, makeMove only touches the squares the move changes
+    // and unmakeMove reverses it from the undo stack
+    // moves are added to the end of the list, fromMask limits generation to the pieces on those squares
+    void generateLegalMoves(MoveList& moves, MoveGenType type = GenAll, uint64_t fromMask = ~0ULL) const;
+    // is move (flags included) one of the legal moves here, for hash and killer moves that came from another position
+    bool isLegalMove(BitMove move) const;
+    void makeMove(BitMove move);
+    void unmakeMove(BitMove move);
+    int movesPlayed() const { return (int)_undoStack.size(); }
+
+    // pass the turn without moving, for null move pruning in the search
+    void makeNullMove();
+    void unmakeNullMove();
+
+private:
+    // everything makeMove can't work backwards from the move itself
+    struct UndoInfo {
+        uint8_t captured;
+        uint8_t castling;
+        int8_t enPassant;
+        int halfmoveClock;
+        uint64_t key;
+    };
+
+    void removePiece(int square);
+    void movePiece(int from, int to);
+
+    // legal generation helpers, the masks come from generateLegalMoves
+    uint64_t attackersTo(int square, int byColor, uint64_t occupied) const;
+    uint64_t attackedSquares(int byColor, uint64_t occupied) const;
+    uint64_t pinnedPieces(int color, int king) const;
+    uint64_t pieceAttacks(ChessPiece piece, int square, uint64_t occupied) const;
+    void addPawnMoves(MoveList& moves, uint64_t pawnMoves, int shift, int flags) const;
+    void generatePawnMoves(MoveList& moves, uint64_t pawns, uint64_t targetMask, MoveGenType type) const;
+    void generateEnPassantMoves(MoveList& moves, uint64_t pawns, int king, uint64_t checkers, uint64_t targetMask) const;
+    void generateCastleMoves(MoveList& moves, uint64_t kingDanger) const;
+
+    uint64_t _pieces[2][7];
+    uint64_t _occupancy[2];
+    uint8_t _board[64];
+    int _sideToMove;
+    int _castling;
+    int _enPassant;
+    int _halfmoveClock;
+    int _fullmoveNumber;
+    uint64_t _key;
+    int _midgame;
+    int _endgame;
+    int _phase;
+
+    std::vector<UndoInfo> _undoStack;
+};
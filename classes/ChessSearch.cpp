@@ -0,0 +1,414 @@
+#include "ChessSearch.h"
+#include "ChessEval.h"
+
+#include <algorithm>
+#include <cstring>
+
+// mate scores are stored relative to the node so they stay right wherever the entry is found again
+static int scoreToTable(int score, int ply) {
+    if (score >= MATE_BOUND) return score + ply;
+    if (score <= -MATE_BOUND) return score - ply;
+    return score;
+}
+
+static int scoreFromTable(int score, int ply) {
+    if (score >= MATE_BOUND) return score - ply;
+    if (score <= -MATE_BOUND) return score + ply;
+    return score;
+}
+
+#pragma region SEARCH THREAD
+
+SearchThread::SearchThread(ChessSearch& owner, int id)
+    : _owner(owner), _id(id), _nodes(0), _completedDepth(0), _bestScore(0), _stopped(false), _network(nullptr)
+{
+    for (int ply = 0; ply <= MAX_PLY; ply++) {
+        _pvLength[ply] = 0;
+    }
+}
+
+void SearchThread::run(const ChessPosition& position, int startDepth, int maxDepth)
+{
+    _position = position;
+    for (int ply = 0; ply <= MAX_PLY; ply++) {
+        _killers[ply][0] = _killers[ply][1] = BitMove();
+    }
+    std::memset(_history, 0, sizeof(_history));
+    _network = _owner._network.loaded() ? &_owner._network : nullptr;
+    if (_network) {
+        _network->refresh(_position, _accumulators[0], WHITE);
+        _network->refresh(_position, _accumulators[0], BLACK);
+    }
+    _bestMove = BitMove();
+    _bestScore = 0;
+    _stopped = false;
+
+    for (int depth = startDepth; depth <= maxDepth; depth++) {
+        int score = search(depth, 0, -INFINITE_SCORE, INFINITE_SCORE, false);
+        if (_stopped) {
+            break; // a partial iteration can't be trusted, keep the last finished one
+        }
+
+        if (_pvLength[0] > 0) {
+            _bestMove = _pv[0][0];
+            _bestScore = score;
+        }
+        _completedDepth = depth;
+        _owner.reportIteration(*this, depth, score, _pv[0], _pvLength[0]);
+
+        // no point looking deeper once we've found the fastest mate
+        if (score >= MATE_BOUND || score <= -MATE_BOUND) {
+            break;
+        }
+    }
+}
+
+void SearchThread::resetCounters()
+{
+    _nodes = 0;
+    _completedDepth = 0;
+}
+
+bool SearchThread::checkLimits()
+{
+    // only the main thread keeps an eye on the budget, the helpers just follow the stop flag
+    if (_id == 0 && (_nodes.load(std::memory_order_relaxed) & 2047) == 0) {
+        _owner.checkBudget();
+    }
+    if (_owner.stopRequested()) {
+        _stopped = true;
+    }
+    return _stopped;
+}
+
+int SearchThread::search(int depth, int ply, int alpha, int beta, bool allowNull)
+{
+    ChessPosition& position = _position;
+    _pvLength[ply] = 0;
+
+    if (ply > 0 && (position.isRepetition() || position.halfmoveClock() >= 100)) {
+        return 0;
+    }
+    if (ply >= MAX_PLY) {
+        return staticEval(ply);
+    }
+
+    bool inCheck = position.inCheck();
+    if (inCheck) {
+        depth++; // don't stop searching with the king in check
+    }
+    if (depth <= 0) {
+        return quiescence(ply, alpha, beta);
+    }
+
+    countNode();
+    if (checkLimits()) {
+        return 0;
+    }
+
+    bool pvNode = beta - alpha > 1;
+    int originalAlpha = alpha;
+
+    TTEntry entry;
+    BitMove ttMove;
+    if (_owner._table.probe(position.key(), entry)) {
+        ttMove = entry.move;
+        if (!pvNode && ply > 0 && entry.depth >= depth) {
+            int ttScore = scoreFromTable(entry.score, ply);
+            if (entry.bound == BoundExact
+                || (entry.bound == BoundLower && ttScore >= beta)
+                || (entry.bound == BoundUpper && ttScore <= alpha)) {
+                return ttScore;
+            }
+        }
+    }
+
+    // null move pruning: if passing still leaves us above beta, a real move will be too
+    // (skipped without pieces, where zugzwang makes passing look better than it is)
+    if (allowNull && !pvNode && !inCheck && depth >= 3 && hasNonPawnMaterial(position.sideToMove())
+        && staticEval(ply) >= beta) {
+        if (_network) {
+            _accumulators[ply + 1] = _accumulators[ply];
+        }
+        position.makeNullMove();
+        int score = -search(depth - 3, ply + 1, -beta, -beta + 1, false);
+        position.unmakeNullMove();
+        if (_stopped) {
+            return 0;
+        }
+        if (score >= beta) {
+            return score >= MATE_BOUND ? beta : score;
+        }
+    }
+
+    MovePicker picker(position, _moveLists[ply], _moveScores[ply], ttMove, _killers[ply], _history, false);
+
+    int bestScore = -INFINITE_SCORE;
+    BitMove bestMove;
+    int movesSearched = 0;
+    for (BitMove move = picker.next(); !move.isNull(); move = picker.next()) {
+        makeMove(move, ply);
+        int score;
+        if (movesSearched == 0) {
+            score = -search(depth - 1, ply + 1, -beta, -alpha, true);
+        } else {
+            // everything after the first move only has to prove it isn't better
+            score = -search(depth - 1, ply + 1, -alpha - 1, -alpha, true);
+            if (score > alpha && score < beta) {
+                score = -search(depth - 1, ply + 1, -beta, -alpha, true);
+            }
+        }
+        position.unmakeMove(move);
+        movesSearched++;
+
+        if (_stopped) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+            if (score > alpha) {
+                alpha = score;
+                _pv[ply][0] = move;
+                for (int j = 0; j < _pvLength[ply + 1]; j++) {
+                    _pv[ply][j + 1] = _pv[ply + 1][j];
+                }
+                _pvLength[ply] = _pvLength[ply + 1] + 1;
+            }
+            if (alpha >= beta) {
+                if (!move.isCapture() && !move.isPromotion()) {
+                    updateQuietStats(move, depth, ply);
+                }
+                break;
+            }
+        }
+    }
+
+    // nothing legal to play: mate or stalemate
+    if (movesSearched == 0) {
+        return inCheck ? -MATE_SCORE + ply : 0;
+    }
+
+    TTBound bound = bestScore >= beta ? BoundLower : (bestScore > originalAlpha ? BoundExact : BoundUpper);
+    _owner._table.store(position.key(), bestMove, scoreToTable(bestScore, ply), depth, bound);
+
+    return bestScore;
+}
+
+int SearchThread::quiescence(int ply, int alpha, int beta)
+{
+    ChessPosition& position = _position;
+    _pvLength[ply] = 0;
+
+    countNode();
+    if (checkLimits()) {
+        return 0;
+    }
+
+    int standPat = staticEval(ply);
+    if (ply >= MAX_PLY) {
+        return standPat;
+    }
+    if (standPat >= beta) {
+        return standPat;
+    }
+    if (standPat > alpha) {
+        alpha = standPat;
+    }
+
+    // only captures and promotions, quiet moves are what the stand pat score stands in for
+    MovePicker picker(position, _moveLists[ply], _moveScores[ply], BitMove(), nullptr, nullptr, true);
+
+    int bestScore = standPat;
+    for (BitMove move = picker.next(); !move.isNull(); move = picker.next()) {
+        makeMove(move, ply);
+        int score = -quiescence(ply + 1, -beta, -alpha);
+        position.unmakeMove(move);
+
+        if (_stopped) {
+            return 0;
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+            }
+            if (alpha >= beta) {
+                break;
+            }
+        }
+    }
+    return bestScore;
+}
+
+int SearchThread::staticEval(int ply)
+{
+    return _network ? _network->evaluate(_position, _accumulators[ply]) : evaluate(_position);
+}
+
+void SearchThread::makeMove(BitMove move, int ply)
+{
+    if (!_network) {
+        _position.makeMove(move);
+        return;
+    }
+    int us = _position.sideToMove();
+    NnueAccumulator& child = _accumulators[ply + 1];
+    _network->update(_position, move, _accumulators[ply], child);
+    _position.makeMove(move);
+    // a king move leaves the mover's side stale, rebuild it here once so every node below can update from it
+    if (!child.computed[us]) {
+        _network->refresh(_position, child, us);
+    }
+}
+
+void SearchThread::updateQuietStats(BitMove move, int depth, int ply)
+{
+    if (!(move == _killers[ply][0])) {
+        _killers[ply][1] = _killers[ply][0];
+        _killers[ply][0] = move;
+    }
+
+    // the bonus shrinks as the score nears HistoryMax, so deep cutoffs count more and nothing overflows
+    int& history = _history[_position.sideToMove()][move.from()][move.to()];
+    int bonus = std::min(depth * depth, HistoryMax);
+    history += bonus - history * bonus / HistoryMax;
+}
+
+bool SearchThread::hasNonPawnMaterial(int color) const
+{
+    return _position.pieces(color, Knight) | _position.pieces(color, Bishop)
+         | _position.pieces(color, Rook) | _position.pieces(color, Queen);
+}
+
+#pragma endregion
+
+#pragma region CHESS SEARCH
+
+ChessSearch::ChessSearch(size_t hashMegabytes, int threadCount)
+    : _table(hashMegabytes), _stop(false)
+{
+    setThreadCount(threadCount);
+}
+
+void ChessSearch::setThreadCount(int count)
+{
+    if (count < 1) {
+        count = 1;
+    }
+    _threads.clear();
+    for (int id = 0; id < count; id++) {
+        _threads.push_back(std::make_unique<SearchThread>(*this, id));
+    }
+}
+
+double ChessSearch::elapsedSeconds() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - _startTime).count();
+}
+
+bool ChessSearch::stopRequested() const
+{
+    return _stop.load(std::memory_order_relaxed) || (_limits.stop && _limits.stop->load(std::memory_order_relaxed));
+}
+
+// called by the main thread every couple of thousand nodes
+void ChessSearch::checkBudget()
+{
+    if (_limits.maxNodes && nodes() >= _limits.maxNodes) {
+        _stop = true;
+    }
+    if (_limits.moveTimeMs && elapsedSeconds() * 1000.0 >= _limits.moveTimeMs) {
+        _stop = true;
+    }
+}
+
+uint64_t ChessSearch::nodes() const
+{
+    uint64_t total = 0;
+    for (auto& thread : _threads) {
+        total += thread->nodes();
+    }
+    return total;
+}
+
+std::vector<SearchThreadInfo> ChessSearch::threadInfo() const
+{
+    std::vector<SearchThreadInfo> info;
+    for (auto& thread : _threads) {
+        info.push_back({ thread->completedDepth(), thread->nodes() });
+    }
+    return info;
+}
+
+// the main thread's iterations are the ones that get reported
+void ChessSearch::reportIteration(const SearchThread& thread, int depth, int score, const BitMove* pv, int pvLength)
+{
+    if (thread.id() != 0 || !_infoCallback) {
+        return;
+    }
+    SearchInfo info;
+    info.depth = depth;
+    info.score = score;
+    info.nodes = nodes();
+    info.seconds = elapsedSeconds();
+    info.nps = info.seconds > 0 ? (uint64_t)(info.nodes / info.seconds) : 0;
+    info.pv.assign(pv, pv + pvLength);
+    info.threads = threadInfo();
+    _infoCallback(info);
+}
+
+BitMove ChessSearch::think(ChessPosition& position, const SearchLimits& limits)
+{
+    _limits = limits;
+    _startTime = std::chrono::steady_clock::now();
+    _stop = false;
+    _table.newSearch();
+
+    BitMove bestMove;
+    MoveList rootMoves;
+    position.generateLegalMoves(rootMoves);
+    if (rootMoves.empty()) {
+        return bestMove;
+    }
+    bestMove = rootMoves[0]; // something legal to play even if the first iteration gets cut off
+
+    for (auto& thread : _threads) {
+        thread->resetCounters();
+    }
+
+    int maxDepth = limits.maxDepth > 0 && limits.maxDepth < MAX_PLY ? limits.maxDepth : MAX_PLY;
+
+    // helpers start a ply or two deeper than the main thread so they aren't all doing the same
+    // iteration at once, what they find goes into the table and speeds the others up
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < _threads.size(); i++) {
+        SearchThread* thread = _threads[i].get();
+        int startDepth = 1 + (thread->id() % 2);
+        helpers.emplace_back([thread, &position, startDepth, maxDepth] () {
+            thread->run(position, startDepth, maxDepth);
+        });
+    }
+    _threads[0]->run(position, 1, maxDepth);
+
+    // the main thread decides when the search is over
+    _stop = true;
+    for (auto& helper : helpers) {
+        helper.join();
+    }
+
+    // take the move from whichever thread got deepest, the main thread wins ties
+    const SearchThread* best = nullptr;
+    for (auto& thread : _threads) {
+        if (thread->completedDepth() > 0 && (!best || thread->completedDepth() > best->completedDepth())) {
+            best = thread.get();
+        }
+    }
+    if (best) {
+        bestMove = best->bestMove();
+    }
+    return bestMove;
+}
+
+#pragma endregion
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "ChessPosition.h"
+#include "MovePicker.h"
+#include "Nnue.h"
+#include "TranspositionTable.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//
+// alpha-beta search for chess: iterative deepening principal variation search with a
+// transposition table, null move pruning and a captures-only quiescence search
+// it scales across cores with lazy SMP: every thread searches the same root with its own copy of
+// the position, and they only talk to each other through the shared transposition table
+// like the rest of chesscore it doesn't log anything itself, progress goes out through the info callback
+//
+
+constexpr int MAX_PLY = 64;
+constexpr int INFINITE_SCORE = 32000;
+constexpr int MATE_SCORE = 31000;
+constexpr int MATE_BOUND = MATE_SCORE - MAX_PLY; // anything past this is a forced mate
+
+// zero means no limit, if everything is zero the search stops at MAX_PLY
+// stop belongs to the caller, setting it from another thread ends the search early
+struct SearchLimits {
+    int maxDepth = 0;
+    uint64_t maxNodes = 0;
+    int moveTimeMs = 0;
+    const std::atomic<bool>* stop = nullptr;
+};
+
+struct SearchThreadInfo {
+    int depth;          // deepest iteration the thread has finished
+    uint64_t nodes;
+};
+
+// reported after every iteration the main thread finishes, from whatever thread is running think()
+struct SearchInfo {
+    int depth;
+    int score;
+    uint64_t nodes;     // all threads together
+    double seconds;
+    uint64_t nps;
+    std::vector<BitMove> pv;
+    std::vector<SearchThreadInfo> threads;
+};
+
+class ChessSearch;
+
+// one thread's worth of search state
+class SearchThread
+{
+public:
+    SearchThread(ChessSearch& owner, int id);
+
+    // iterative deepening from startDepth, until maxDepth or until the search is stopped
+    void run(const ChessPosition& position, int startDepth, int maxDepth);
+    // zero the counts before any thread starts, so totals never mix in the last search's nodes
+    void resetCounters();
+
+    int id() const { return _id; }
+    uint64_t nodes() const { return _nodes.load(std::memory_order_relaxed); }
+    int completedDepth() const { return _completedDepth.load(std::memory_order_relaxed); }
+    BitMove bestMove() const { return _bestMove; }
+    int bestScore() const { return _bestScore; }
+
+private:
+    int search(int depth, int ply, int alpha, int beta, bool allowNull);
+    int quiescence(int ply, int alpha, int beta);
+
+    // the network's evaluation when one is loaded, the hand written one otherwise
+    int staticEval(int ply);
+    // make the move, carrying the network's accumulator from ply to ply + 1 when there is one
+    void makeMove(BitMove move, int ply);
+
+    // a quiet move caused a cutoff: remember it as a killer for this ply and give it some history
+    void updateQuietStats(BitMove move, int depth, int ply);
+    bool hasNonPawnMaterial(int color) const;
+
+    bool checkLimits();
+    // only this thread writes its count, the others just read it
+    void countNode() { _nodes.store(_nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+    ChessSearch& _owner;
+    int _id;
+    ChessPosition _position;
+    std::atomic<uint64_t> _nodes;
+    std::atomic<int> _completedDepth;
+    BitMove _bestMove;
+    int _bestScore;
+    bool _stopped;
+
+    // per ply scratch space so the search doesn't allocate as it goes
+    MoveList _moveLists[MAX_PLY + 1];
+    int _moveScores[MAX_PLY + 1][MoveList::Capacity];
+    BitMove _pv[MAX_PLY + 1][MAX_PLY + 1];
+    int _pvLength[MAX_PLY + 1];
+
+    // move ordering that carries across the tree, cleared at the start of every search
+    BitMove _killers[MAX_PLY + 1][2];
+    int _history[2][64][64];
+
+    // the network's first layer at each ply, only used when the owner has a network loaded
+    const NnueNetwork* _network;
+    NnueAccumulator _accumulators[MAX_PLY + 1];
+};
+
+class ChessSearch
+{
+public:
+    ChessSearch(size_t hashMegabytes = 16, int threadCount = 1);
+
+    // search position (it is left exactly as it came in) and return the best move,
+    // a null move (from == to) if there are no legal moves
+    BitMove think(ChessPosition& position, const SearchLimits& limits);
+
+    void setInfoCallback(std::function<void(const SearchInfo&)> callback) { _infoCallback = callback; }
+    void setHashSize(size_t megabytes) { _table.resize(megabytes); }
+    void clearHash() { _table.clear(); }
+
+    // like the hash size, only change these between searches
+    void setThreadCount(int count);
+    int threadCount() const { return (int)_threads.size(); }
+    // evaluate with the network file at path from now on, false (and back to the hand written evaluation) if it won't load
+    bool loadNetwork(const std::string& path) { return _network.load(path); }
+    void unloadNetwork() { _network.unload(); }
+    bool hasNetwork() const { return _network.loaded(); }
+
+    // every thread's nodes from the last (or current) search
+    uint64_t nodes() const;
+    std::vector<SearchThreadInfo> threadInfo() const;
+
+private:
+    friend class SearchThread;
+
+    bool stopRequested() const;
+    void checkBudget();
+    void reportIteration(const SearchThread& thread, int depth, int score, const BitMove* pv, int pvLength);
+    double elapsedSeconds() const;
+
+    TranspositionTable _table;
+    NnueNetwork _network;
+    std::vector<std::unique_ptr<SearchThread>> _threads;
+    SearchLimits _limits;
+    std::chrono::steady_clock::time_point _startTime;
+    std::atomic<bool> _stop;
+
+    std::function<void(const SearchInfo&)> _infoCallback;
+};
@@ -15,6 +15,7 @@ Game::Game()
 	_gameOptions.rowY = 0;
 	_gameOptions.score = 0;
 	_gameOptions.AIDepthSearches = 0;
+	_gameOptions.AIMAXDepth = 0;
 	_gameOptions.AIvsAI = false;
 
 	_table = nullptr;
@@ -83,6 +84,7 @@ void Game::startGame()
 	std::string startState = stateString();
 	Turn *turn = _turns.at(0);
 	turn->_boardState = startState;
+	turn->_positionKey = positionKey();
 	turn->_gameNumber = _gameOptions.gameNumber;
 	_gameOptions.currentTurnNo = 0;
 }
@@ -90,9 +92,9 @@ void Game::startGame()
 void Game::endTurn()
 {
 	_gameOptions.currentTurnNo++;
-	std::string startState = stateString();
 	Turn *turn = new Turn;
 	turn->_boardState = stateString();
+	turn->_positionKey = positionKey();
 	turn->_date = (int)_gameOptions.currentTurnNo;
 	turn->_score = _gameOptions.score;
 	turn->_gameNumber = _gameOptions.gameNumber;
@@ -119,19 +121,16 @@ void Game::scanForMouse()
 	mousePos.x -= ImGui::GetWindowPos().x;
 	mousePos.y -= ImGui::GetWindowPos().y;
 
-	Entity *entity = nullptr;
-	Grid* grid = getGrid();
-	grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-		Bit *bit = square->bit();
+	// only the square under the mouse (and whatever is on it) can be hit
+	Entity *entity = getGrid()->getSquareAtPoint(mousePos);
+	if (entity)
+	{
+		Bit *bit = ((ChessSquare *)entity)->bit();
 		if (bit && bit->isMouseOver(mousePos))
 		{
 			entity = bit;
 		}
-		else if (square->isMouseOver(mousePos))
-		{
-			entity = square;
-		}
-	});
+	}
 	if (ImGui::IsMouseClicked(0))
 	{
 		mouseDown(mousePos, entity);
@@ -148,27 +147,22 @@ void Game::scanForMouse()
 
 void Game::findDropTarget(ImVec2 &pos)
 {
-	Grid* grid = getGrid();
-	grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-		if (square == _oldHolder)
-		{
-			return;
-		}
-		if (square->isMouseOver(pos))
-		{
-			if (_dropTarget && square != _dropTarget)
-			{
-				_dropTarget->willNotDropBit(_dragBit);
-				_dropTarget->setHighlighted(false);
-				_dropTarget = nullptr;
-			}
-			if (_oldHolder && square->canDropBitAtPoint(_dragBit, pos) && canBitMoveFromTo(*_dragBit, *_oldHolder, *square))
-			{
-				_dropTarget = square;
-				_dropTarget->setHighlighted(true);
-			}
-		}
-	});
+	ChessSquare *square = getGrid()->getSquareAtPoint(pos);
+	if (!square || square == _oldHolder)
+	{
+		return;
+	}
+	if (_dropTarget && square != _dropTarget)
+	{
+		_dropTarget->willNotDropBit(_dragBit);
+		_dropTarget->setHighlighted(false);
+		_dropTarget = nullptr;
+	}
+	if (_oldHolder && square->canDropBitAtPoint(_dragBit, pos) && canBitMoveFromTo(*_dragBit, *_oldHolder, *square))
+	{
+		_dropTarget = square;
+		_dropTarget->setHighlighted(true);
+	}
 }
 
 //
@@ -179,37 +173,78 @@ void Game::drawFrame()
 {
 	scanForMouse();
 
-	Grid* grid = getGrid();
+	// one walk over the board collects everything to paint, tagged with its layer from bitz
+	_drawItems.clear();
+	ImVec2 extent(0, 0);
+	getGrid()->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
+		_drawItems.push_back({ kBoardZ, square->getTexture(), square });
+		extent.x = std::max(extent.x, square->getPosition().x + square->getSize().x);
+		extent.y = std::max(extent.y, square->getPosition().y + square->getSize().y);
 
-	// Paint squares
-	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		square->paintSprite();
-	});
-
-	// Paint stationary pieces
-	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		if (square->bit() && !square->bit()->getPickedUp() && !square->bit()->getMoving())
+		Bit *bit = square->bit();
+		if (!bit)
 		{
-			square->bit()->paintSprite();
+			return;
 		}
-	});
-
-	// Paint moving pieces
-	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		if (square->bit() && square->bit()->getMoving() && !square->bit()->getPickedUp())
+		int z = kPieceZ;
+		if (bit->getPickedUp())
+		{
+			z = kPickupUpZ;
+		}
+		else if (bit->getMoving())
 		{
-			square->bit()->update();
-			square->bit()->paintSprite();
+			bit->update();
+			z = kMovingZ;
 		}
+		_drawItems.push_back({ z, bit->getTexture(), bit });
 	});
 
-	// Paint picked up pieces
-	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		if (square->bit() && square->bit()->getPickedUp())
+	std::sort(_drawItems.begin(), _drawItems.end(), [](const DrawItem &a, const DrawItem &b) {
+		return a.z != b.z ? a.z < b.z : a.texture < b.texture;
+	});
+
+	// sprites are positioned the same way SetCursorPos places them
+	ImGui::SetCursorPos(ImVec2(0, 0));
+	ImVec2 origin = ImGui::GetCursorScreenPos();
+	ImDrawList *drawList = ImGui::GetWindowDrawList();
+	for (const DrawItem &item : _drawItems)
+	{
+		item.sprite->paintSprite(drawList, origin);
+	}
+
+	// claim the board's area so the window still sizes and scrolls around it
+	ImGui::Dummy(extent);
+}
+
+static std::atomic<void (*)()> redrawRequest{nullptr};
+
+void Game::setRedrawRequest(void (*request)())
+{
+	redrawRequest = request;
+}
+
+void Game::requestRedraw()
+{
+	if (auto request = redrawRequest.load())
+	{
+		request();
+	}
+}
+
+bool Game::isAnimating()
+{
+	if (_dragBit)
+	{
+		return true;
+	}
+	bool moving = false;
+	getGrid()->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
+		if (square->bit() && square->bit()->getMoving())
 		{
-			square->bit()->paintSprite();
+			moving = true;
 		}
 	});
+	return moving;
 }
 
 void Game::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
@@ -55,6 +55,13 @@ public:
 	virtual void setUpBoard() = 0;
 
 	virtual void drawFrame();
+	// true while the board changes without any input, a piece being dragged or animating into place
+	bool isAnimating();
+
+	// wakes a sleeping main loop from any thread, for background work that has something new to show
+	// the platform layer says how with setRedrawRequest, without one this does nothing
+	static void setRedrawRequest(void (*request)());
+	static void requestRedraw();
 
 	// end the current game turn
 	virtual void endTurn();
@@ -95,11 +102,15 @@ public:
 	virtual void stopGame() = 0;
 	virtual bool gameHasAI();
 	virtual void updateAI();
+	// true while the AI works on another thread, the main loop sleeps until requestRedraw() wakes it
+	virtual bool isAIThinking() { return false; }
 	virtual void pieceTaken(Bit *bit){};
 
 	virtual std::string initialStateString() = 0;
 	virtual std::string stateString() = 0;
 	virtual void setStateString(const std::string &s) = 0;
+	// 64 bit hash of the current position, games that don't hash their positions return 0
+	virtual uint64_t positionKey() { return 0; }
 
 	void setNumberOfPlayers(unsigned int playerCount);
 	void setAIPlayer(unsigned int playerNumber);
@@ -143,6 +154,15 @@ protected:
 	void mouseUp(ImVec2 &location, Entity *bit);
 	virtual void findDropTarget(ImVec2 &pos);
 
+	// one sprite to paint this frame, sorted by layer and then texture so the draw list can merge them
+	struct DrawItem
+	{
+		int z;
+		ImTextureID texture;
+		Sprite *sprite;
+	};
+	std::vector<DrawItem> _drawItems;
+
 	ImVec2 _dragStartPos;
 	ImVec2 _dragOffset;
 	ImVec2 _oldPos;
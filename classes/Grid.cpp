@@ -1,42 +1,30 @@
 #include "Grid.h"
+#include <cmath>
 
-Grid::Grid(int width, int height) : _width(width), _height(height)
+Grid::Grid(int width, int height)
+    : _squares(width * height), _enabled((width * height + 63) / 64, 0), _width(width), _height(height),
+      _squareSize(0), _rowsFlipped(false)
 {
-    // Initialize 2D vectors
-    _squares.resize(height);
-    _enabled.resize(height);
-
-    for (int y = 0; y < height; y++) {
-        _squares[y].resize(width);
-        _enabled[y].resize(width);
-
-        for (int x = 0; x < width; x++) {
-            _squares[y][x] = new ChessSquare();
-            _enabled[y][x] = true; // All squares enabled by default
-        }
+    // All squares enabled by default
+    for (int index = 0; index < width * height; index++) {
+        _enabled[index >> 6] |= 1ULL << (index & 63);
     }
 }
 
 Grid::~Grid()
 {
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            delete _squares[y][x];
-        }
-    }
 }
 
 ChessSquare* Grid::getSquare(int x, int y)
 {
     if (!isValid(x, y)) return nullptr;
-    return _squares[y][x];
+    return &_squares[getIndex(x, y)];
 }
 
 ChessSquare* Grid::getSquareByIndex(int index)
 {
-    int x, y;
-    getCoordinates(index, x, y);
-    return getSquare(x, y);
+    if (index < 0 || index >= (int)_squares.size()) return nullptr;
+    return &_squares[index];
 }
 
 bool Grid::isValid(int x, int y) const
@@ -47,13 +35,19 @@ bool Grid::isValid(int x, int y) const
 bool Grid::isEnabled(int x, int y) const
 {
     if (!isValid(x, y)) return false;
-    return _enabled[y][x];
+    return enabledAt(getIndex(x, y));
 }
 
 void Grid::setEnabled(int x, int y, bool enabled)
 {
     if (isValid(x, y)) {
-        _enabled[y][x] = enabled;
+        int index = getIndex(x, y);
+        uint64_t bit = 1ULL << (index & 63);
+        if (enabled) {
+            _enabled[index >> 6] |= bit;
+        } else {
+            _enabled[index >> 6] &= ~bit;
+        }
     }
 }
 
@@ -63,6 +57,18 @@ void Grid::getCoordinates(int index, int& x, int& y) const
     y = index / _width;
 }
 
+ChessSquare* Grid::getSquareAtPoint(const ImVec2& point)
+{
+    if (_squareSize <= 0) return nullptr;
+    // squares are placed with their top left corner half a square in from the board edge
+    int x = (int)std::floor((point.x - _squareSize / 2) / _squareSize);
+    int row = (int)std::floor((point.y - _squareSize / 2) / _squareSize);
+    int y = _rowsFlipped ? _height - 1 - row : row;
+    if (!isEnabled(x, y)) return nullptr;
+    ChessSquare* square = &_squares[getIndex(x, y)];
+    return square->isMouseOver(point) ? square : nullptr;
+}
+
 // Directional helpers
 ChessSquare* Grid::getFL(int x, int y)
 {
@@ -149,30 +155,11 @@ bool Grid::areConnected(int fromX, int fromY, int toX, int toY)
     return false;
 }
 
-// Iterator support
-void Grid::forEachSquare(std::function<void(ChessSquare*, int x, int y)> func)
-{
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            func(_squares[y][x], x, y);
-        }
-    }
-}
-
-void Grid::forEachEnabledSquare(std::function<void(ChessSquare*, int x, int y)> func)
-{
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            if (_enabled[y][x]) {
-                func(_squares[y][x], x, y);
-            }
-        }
-    }
-}
-
 // Initialize squares
 void Grid::initializeSquares(float squareSize, const char* spriteName)
 {
+    _squareSize = squareSize;
+    _rowsFlipped = false;
     for (int y = 0; y < _height; y++) {
         for (int x = 0; x < _width; x++) {
             initializeSquare(x, y, squareSize, spriteName);
@@ -183,10 +170,12 @@ void Grid::initializeSquares(float squareSize, const char* spriteName)
 // chess board starts at bottom a1 = 0,0
 void Grid::initializeChessSquares(float squareSize, const char* spriteName)
 {
+    _squareSize = squareSize;
+    _rowsFlipped = true;
     for (int y = 0; y < _height; y++) {
         for (int x = 0; x < _width; x++) {
-            ImVec2 position(squareSize * x + squareSize/2, squareSize * (7-y) + squareSize/2);
-            _squares[y][x]->initHolder(position, spriteName, x, y);
+            ImVec2 position(squareSize * x + squareSize/2, squareSize * (_height-1-y) + squareSize/2);
+            _squares[getIndex(x, y)].initHolder(position, spriteName, x, y);
         }
     }
 }
@@ -195,7 +184,7 @@ void Grid::initializeSquare(int x, int y, float squareSize, const char* spriteNa
 {
     if (isValid(x, y)) {
         ImVec2 position(squareSize * x + squareSize/2, squareSize * y + squareSize/2);
-        _squares[y][x]->initHolder(position, spriteName, x, y);
+        _squares[getIndex(x, y)].initHolder(position, spriteName, x, y);
     }
 }
 
@@ -203,16 +192,15 @@ void Grid::initializeSquare(int x, int y, float squareSize, const char* spriteNa
 std::string Grid::getStateString() const
 {
     std::string state;
-
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            if (_enabled[y][x]) {
-                Bit* bit = _squares[y][x]->bit();
-                if (bit) {
-                    state += std::to_string(bit->gameTag());
-                } else {
-                    state += '0';
-                }
+    state.reserve(_squares.size());
+
+    for (int index = 0; index < (int)_squares.size(); index++) {
+        if (enabledAt(index)) {
+            Bit* bit = _squares[index].bit();
+            if (bit) {
+                state += std::to_string(bit->gameTag());
+            } else {
+                state += '0';
             }
         }
     }
@@ -224,17 +212,15 @@ void Grid::setStateString(const std::string& state)
 {
     size_t index = 0;
 
-    for (int y = 0; y < _height && index < state.length(); y++) {
-        for (int x = 0; x < _width && index < state.length(); x++) {
-            if (_enabled[y][x]) {
-                char pieceChar = state[index++];
+    for (int square = 0; square < (int)_squares.size() && index < state.length(); square++) {
+        if (enabledAt(square)) {
+            char pieceChar = state[index++];
 
-                // Clear existing piece
-                _squares[y][x]->destroyBit();
+            // Clear existing piece
+            _squares[square].destroyBit();
 
-                // This method just sets the state - games need to create their own pieces
-                // when loading from state string based on the piece type
-            }
+            // This method just sets the state - games need to create their own pieces
+            // when loading from state string based on the piece type
         }
     }
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ChessSquare.h"
+#include <stdint.h>
 #include <vector>
 #include <unordered_map>
 #include <functional>
@@ -24,6 +25,9 @@ public:
     int getHeight() const { return _height; }
     int getIndex(int x, int y) const { return y * _width + x; }
     void getCoordinates(int index, int& x, int& y) const;
+    // the enabled square under a point in board space, worked out from the layout the squares were
+    // initialized with rather than by testing every square
+    ChessSquare* getSquareAtPoint(const ImVec2& point);
 
     // Directional helpers (built into Grid)
     ChessSquare* getFL(int x, int y);  // front-left (up-left diagonal)
@@ -50,8 +54,27 @@ public:
     bool areConnected(int fromX, int fromY, int toX, int toY);
 
     // Iterator support
-    void forEachSquare(std::function<void(ChessSquare*, int x, int y)> func);
-    void forEachEnabledSquare(std::function<void(ChessSquare*, int x, int y)> func);
+    // templates rather than std::function so the callback can be inlined into the loop
+    template <typename Func>
+    void forEachSquare(Func&& func)
+    {
+        ChessSquare* square = _squares.data();
+        for (int y = 0; y < _height; y++) {
+            for (int x = 0; x < _width; x++) {
+                func(square++, x, y);
+            }
+        }
+    }
+
+    template <typename Func>
+    void forEachEnabledSquare(Func&& func)
+    {
+        for (int index = 0; index < (int)_squares.size(); index++) {
+            if (enabledAt(index)) {
+                func(&_squares[index], index % _width, index / _width);
+            }
+        }
+    }
 
     // Initialize squares with positions and sprites
     void initializeChessSquares(float squareSize, const char* spriteName);
@@ -63,9 +86,16 @@ public:
     void setStateString(const std::string& state);
 
 private:
-    std::vector<std::vector<ChessSquare*>> _squares;
-    std::vector<std::vector<bool>> _enabled;
+    bool enabledAt(int index) const { return (_enabled[index >> 6] >> (index & 63)) & 1; }
+
+    // row major, index = y * width + x, one allocation for the whole board
+    std::vector<ChessSquare> _squares;
+    // one bit per square, same order as _squares
+    std::vector<uint64_t> _enabled;
     std::unordered_map<int, std::vector<int>> _connections;
     int _width;
     int _height;
+    // layout from the last initialize call, chess boards put row 0 at the bottom
+    float _squareSize;
+    bool _rowsFlipped;
 };
\ No newline at end of file
@@ -1,31 +1,186 @@
 #include "Logger.h"
 
 #include <iostream>
-#include <list>
 #include <fstream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 
-static Logger* instance;
 std::ofstream logFile;
 
-struct Entry { int num; ImVec4 color; std::string text; };
-int entryNum = 1;
+// display is "num text" without the newline, formatted once when the entry is flushed so drawing it is free
+struct Entry { int num; LogLevel level; std::string text; std::string display; };
+
+//
+// bounded multi producer, single consumer ring buffer (the sequence number scheme from Dmitry Vyukov's
+// bounded queue). any thread can push without taking a lock, the flush thread is the only one popping
+// when it's full new entries are dropped and counted rather than making the caller wait
+//
+class LogRing {
+public:
+    static constexpr size_t Capacity = 4096; // power of two
+
+    LogRing() : _head(0), _tail(0), _dropped(0) {
+        for (size_t i = 0; i < Capacity; i++) {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(LogLevel level, std::string&& text) {
+        size_t position = _head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = _slots[position & (Capacity - 1)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+            if (difference == 0) {
+                // the slot is free, claim it by moving the head on
+                if (_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.level = level;
+                    slot.text = std::move(text);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return false; // full, the consumer hasn't got to this slot yet
+            } else {
+                position = _head.load(std::memory_order_relaxed);
+            }
+        }
+    }
 
-std::list<Entry> fullLog;
+    bool pop(LogLevel& level, std::string& text) {
+        Slot& slot = _slots[_tail & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != _tail + 1) {
+            return false; // empty, or the producer is still writing it
+        }
+        level = slot.level;
+        text = std::move(slot.text);
+        slot.sequence.store(_tail + Capacity, std::memory_order_release);
+        _tail++;
+        return true;
+    }
+
+    size_t takeDropped() { return _dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogLevel level;
+        std::string text;
+    };
+
+    Slot _slots[Capacity];
+    alignas(64) std::atomic<size_t> _head;
+    alignas(64) size_t _tail;
+    std::atomic<size_t> _dropped;
+};
+
+static LogRing ring;
+
+// the flush thread owns the file and writes whole batches, the game log window reads a capped
+// history of what it has flushed
+static constexpr size_t HistoryCapacity = 5000;
+static std::thread flushThread;
+static std::atomic<bool> flushRunning(false);
+static std::mutex flushLock;
+static std::condition_variable flushWake;
+
+static std::mutex historyLock;
+static std::deque<Entry> history;      // oldest first, capped at HistoryCapacity
+static uint64_t historyBase = 0;       // how many entries have ever been trimmed off the front
+static uint64_t historyClears = 0;     // bumped by ClearLog, so the UI knows to start over
+static int entryNum = 1;
+
+// what the UI thread draws, a copy of history that only takes on the new entries each frame
+// entries are addressed by their absolute position (base + offset) so trimming the front doesn't move them
+static std::deque<Entry> snapshot;
+static uint64_t snapshotBase = 0;
+static uint64_t snapshotClears = 0;
+
+// the entries that pass the level and text filters, newest last, as absolute positions in snapshot
+static std::deque<uint64_t> filtered;
+static bool showLevel[LogLevelNone] = { true, true, true, true, true };
+static ImGuiTextFilter textFilter;
+
+static void drainRing() {
+    std::vector<Entry> batch;
+    LogLevel level;
+    std::string text;
+    while (ring.pop(level, text)) {
+        batch.push_back({ 0, level, std::move(text), {} });
+    }
+    size_t dropped = ring.takeDropped();
+    if (dropped) {
+        batch.push_back({ 0, LogLevelWarning, "[warning] log buffer full, dropped " + std::to_string(dropped) + " entries\n", {} });
+    }
+    if (batch.empty()) {
+        return;
+    }
 
-Logger::Logger() {
+    std::string block;
+    for (const Entry& entry : batch) {
+        block += entry.text;
+    }
+    logFile << block;
+    logFile.flush();
+
+    std::lock_guard<std::mutex> lock(historyLock);
+    for (Entry& entry : batch) {
+        entry.num = entryNum++;
+        entry.display = std::to_string(entry.num) + " " + entry.text;
+        if (!entry.display.empty() && entry.display.back() == '\n') {
+            entry.display.pop_back();
+        }
+        history.push_back(std::move(entry));
+    }
+    while (history.size() > HistoryCapacity) {
+        history.pop_front();
+        historyBase++;
+    }
+}
+
+static void flushLoop() {
+    while (flushRunning.load(std::memory_order_acquire)) {
+        drainRing();
+        std::unique_lock<std::mutex> lock(flushLock);
+        flushWake.wait_for(lock, std::chrono::milliseconds(50));
+    }
+    drainRing(); // whatever came in while we were shutting down
+}
+
+// registered with atexit so the last entries still make it to the file
+static void stopFlushThread() {
+    if (flushRunning.exchange(false)) {
+        flushWake.notify_one();
+        flushThread.join();
+    }
+}
+
+Logger::Logger() : _level(LogLevelDebug) {
     logFile.open("LoggerOutput.txt");
     logFile << "test" << std::endl;
+
+    flushRunning = true;
+    flushThread = std::thread(flushLoop);
+    std::atexit(stopFlushThread);
 }
 
 Logger& Logger::GetInstance() {
 
-    if (!instance) {
-        instance = new Logger();
-    }
+    // thread safe the first time too, search workers can log before the UI does
+    static Logger* instance = new Logger();
     return *instance;
 }
 
 Logger::~Logger() {
+    stopFlushThread();
     logFile.close();
 }
 
@@ -41,17 +196,84 @@ void Logger::RenderGame() {
     ImGui::End();
 }
 
-void Logger::RenderText() {
+static ImVec4 LevelColor(LogLevel level) {
+    switch (level) {
+        case LogLevelDebug:     return ImVec4(0.6f, 0.6f, 0.6f, 1);
+        case LogLevelGameEvent: return ImVec4(0.5f, 1, 0.5f, 1);
+        case LogLevelWarning:   return ImVec4(1, 1, 0.5f, 1);
+        case LogLevelError:     return ImVec4(1, 0.2f, 0.2f, 1);
+        default:                return ImVec4(1, 1, 1, 1);
+    }
+}
+
+static bool PassesFilters(const Entry& entry) {
+    return showLevel[entry.level] && textFilter.PassFilter(entry.display.c_str(), entry.display.c_str() + entry.display.size());
+}
 
-    ImGui::TextUnformatted("\n");
+static void RebuildFiltered() {
+    filtered.clear();
+    for (size_t i = 0; i < snapshot.size(); i++) {
+        if (PassesFilters(snapshot[i])) {
+            filtered.push_back(snapshotBase + i);
+        }
+    }
+}
 
-    for (Entry entry : fullLog) {
-        
-        ImGui::TextColored(entry.color, (std::to_string(entry.num) + " " + entry.text).c_str());
+// bring the snapshot up to date with history, copying only what the UI hasn't seen yet
+static void UpdateSnapshot() {
+    std::lock_guard<std::mutex> lock(historyLock);
+    if (snapshotClears != historyClears) {
+        snapshot.clear();
+        filtered.clear();
+        snapshotBase = historyBase;
+        snapshotClears = historyClears;
     }
 
-    ImGui::LogFinish();
+    uint64_t historyEnd = historyBase + history.size();
+    uint64_t snapshotEnd = snapshotBase + snapshot.size();
+    if (snapshotEnd < historyBase) {
+        // so far behind that everything we had is gone
+        snapshot.clear();
+        filtered.clear();
+        snapshotBase = snapshotEnd = historyBase;
+    }
+    for (uint64_t i = snapshotEnd; i < historyEnd; i++) {
+        snapshot.push_back(history[i - historyBase]);
+        if (PassesFilters(snapshot.back())) {
+            filtered.push_back(i);
+        }
+    }
 
+    while (snapshot.size() > HistoryCapacity) {
+        snapshot.pop_front();
+        snapshotBase++;
+    }
+    while (!filtered.empty() && filtered.front() < snapshotBase) {
+        filtered.pop_front();
+    }
+}
+
+void Logger::RenderText() {
+
+    UpdateSnapshot();
+
+    ImGui::Separator();
+    ImGui::BeginChild("log entries", ImVec2(0, 0), ImGuiChildFlags_None, ImGuiWindowFlags_HorizontalScrollbar);
+
+    // only the rows in view are submitted, newest first
+    ImGuiListClipper clipper;
+    clipper.Begin((int)filtered.size());
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            const Entry& entry = snapshot[filtered[filtered.size() - 1 - row] - snapshotBase];
+            ImGui::PushStyleColor(ImGuiCol_Text, LevelColor(entry.level));
+            ImGui::TextUnformatted(entry.display.c_str(), entry.display.c_str() + entry.display.size());
+            ImGui::PopStyleColor();
+        }
+    }
+    clipper.End();
+
+    ImGui::EndChild();
 }
 
 void Logger::RenderButtons() {
@@ -81,43 +303,63 @@ void Logger::RenderButtons() {
     if (ImGui::Button("Test Error")) 
         LogError("test");
     
+    ImGui::SameLine();
+
+    // runtime threshold, anything compiled out by LOG_COMPILE_LEVEL stays out
+    const char* levels[] = { "debug", "info", "game event", "warning", "error", "none" };
+    int level = GetLevel();
+    ImGui::SetNextItemWidth(120);
+    if (ImGui::Combo("Level", &level, levels, IM_ARRAYSIZE(levels)))
+        SetLevel((LogLevel)level);
+
+    // display filters, these only hide entries that were logged
+    bool filterChanged = false;
+    for (int i = 0; i < LogLevelNone; i++) {
+        if (i > 0) ImGui::SameLine();
+        filterChanged |= ImGui::Checkbox(levels[i], &showLevel[i]);
+    }
+    filterChanged |= textFilter.Draw("Search", 200);
+    if (filterChanged)
+        RebuildFiltered();
 
     ImGui::EndGroup();
 }
 
+void Logger::LogDebug(const std::string debug) {
+
+    CreateAndPushEntry(LogLevelDebug, "[debug] " + debug + '\n');
+}
+
 void Logger::LogInfo(const std::string info) {
 
-    CreateAndPushEntry(ImVec4(1, 1, 1, 1), "[info] " + info + '\n');
+    CreateAndPushEntry(LogLevelInfo, "[info] " + info + '\n');
 }
 
 void Logger::LogGameEvent(const std::string gameEvent) {
 
-    CreateAndPushEntry( ImVec4(0.5f, 1, 0.5f, 1), "[game event] " + gameEvent + '\n');
+    CreateAndPushEntry(LogLevelGameEvent, "[game event] " + gameEvent + '\n');
 }
 
 void Logger::LogWarning(const std::string warning) {
 
-    CreateAndPushEntry( ImVec4(1, 1, 0.5f, 1), "[warning] " + warning + '\n');
+    CreateAndPushEntry(LogLevelWarning, "[warning] " + warning + '\n');
 }
 
 void Logger::LogError(const std::string error) {
-    CreateAndPushEntry(ImVec4(1, 0.2f, 0.2f, 1), "[error] " + error + '\n');
+    CreateAndPushEntry(LogLevelError, "[error] " + error + '\n');
 }
 
-void Logger::CreateAndPushEntry(ImVec4 color, std::string entryText) {
+// any thread can call this, it never blocks on the file
+void Logger::CreateAndPushEntry(LogLevel level, std::string entryText) {
 
-    Entry entry;
-    entry.num = entryNum;
-    entryNum++;
-    entry.color = color;
-    entry.text = entryText;
-    fullLog.push_front(entry);
-
-    logFile << entry.text;
+    ring.push(level, std::move(entryText));
 }
 
 void Logger::ClearLog() {
 
-    fullLog.clear();
+    std::lock_guard<std::mutex> lock(historyLock);
+    history.clear();
+    historyBase = 0;
+    historyClears++;
     entryNum = 1;
-}
\ No newline at end of file
+}
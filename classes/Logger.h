@@ -2,11 +2,39 @@
 
 #include "../imgui/imgui.h"
 
+#include <atomic>
 #include <string>
 
 // this class uses a singleton structure! i learned about them here:
 // https://refactoring.guru/design-patterns/singleton/cpp/example
 
+// numbered for the preprocessor too, so LOG_COMPILE_LEVEL can be compared in #if
+#define LOG_LEVEL_DEBUG      0
+#define LOG_LEVEL_INFO       1
+#define LOG_LEVEL_GAME_EVENT 2
+#define LOG_LEVEL_WARNING    3
+#define LOG_LEVEL_ERROR      4
+#define LOG_LEVEL_NONE       5
+
+enum LogLevel {
+    LogLevelDebug     = LOG_LEVEL_DEBUG,
+    LogLevelInfo      = LOG_LEVEL_INFO,
+    LogLevelGameEvent = LOG_LEVEL_GAME_EVENT,
+    LogLevelWarning   = LOG_LEVEL_WARNING,
+    LogLevelError     = LOG_LEVEL_ERROR,
+    LogLevelNone      = LOG_LEVEL_NONE
+};
+
+// levels below this are compiled out by the LOG_ macros, debug output only exists in debug builds
+// unless the build asks for something else with -DLOG_COMPILE_LEVEL=LOG_LEVEL_...
+#ifndef LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#else
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
 class Logger {
 
     private:
@@ -16,7 +44,7 @@ class Logger {
         void RenderText();
         void RenderButtons();
 
-        void CreateAndPushEntry(ImVec4 color, std::string entryText);
+        void CreateAndPushEntry(LogLevel level, std::string entryText);
 
     public:
 
@@ -25,6 +53,13 @@ class Logger {
         void GameStartUp();
         void RenderGame();
         
+        // runtime threshold, entries below it are dropped before their text is even built
+        // atomic because search and flush threads check it while the UI thread changes it
+        void SetLevel(LogLevel level) { _level.store(level, std::memory_order_relaxed); }
+        LogLevel GetLevel() const { return _level.load(std::memory_order_relaxed); }
+        bool IsEnabled(LogLevel level) const { return level >= _level.load(std::memory_order_relaxed); }
+
+        void LogDebug(const std::string debug);
         void LogInfo(const std::string info);
         void LogGameEvent(const std::string gameEvent);
         void LogWarning(const std::string warning);
@@ -32,4 +67,42 @@ class Logger {
 
         void ClearLog();
 
-};
\ No newline at end of file
+    private:
+        std::atomic<LogLevel> _level;
+
+};
+
+// leveled logging, prefer these over calling the Logger directly
+// a level under LOG_COMPILE_LEVEL expands to nothing at all, so the message expression is never evaluated
+#define LOG_AT_LEVEL(level, method, message) \
+    do { if (Logger::GetInstance().IsEnabled(level)) Logger::GetInstance().method(message); } while (0)
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(message) LOG_AT_LEVEL(LogLevelDebug, LogDebug, message)
+#else
+#define LOG_DEBUG(message) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(message) LOG_AT_LEVEL(LogLevelInfo, LogInfo, message)
+#else
+#define LOG_INFO(message) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_GAME_EVENT
+#define LOG_GAME_EVENT(message) LOG_AT_LEVEL(LogLevelGameEvent, LogGameEvent, message)
+#else
+#define LOG_GAME_EVENT(message) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING(message) LOG_AT_LEVEL(LogLevelWarning, LogWarning, message)
+#else
+#define LOG_WARNING(message) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(message) LOG_AT_LEVEL(LogLevelError, LogError, message)
+#else
+#define LOG_ERROR(message) ((void)0)
+#endif
\ No newline at end of file
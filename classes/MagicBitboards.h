@@ -3,8 +3,10 @@
 
 #include <stdint.h>
 
+#include "AttackTables.h"
+
 // Generate rook attacks for a given square and blocking pieces
-static inline uint64_t ratt(int sq, uint64_t block) {
+inline uint64_t ratt(int sq, uint64_t block) {
     uint64_t result = 0ULL;
     int rk = sq / 8, fl = sq % 8, r, f;
 
@@ -32,7 +34,7 @@ static inline uint64_t ratt(int sq, uint64_t block) {
 }
 
 // Generate bishop attacks for a given square and blocking pieces
-static inline uint64_t batt(int sq, uint64_t block) {
+inline uint64_t batt(int sq, uint64_t block) {
     uint64_t result = 0ULL;
     int rk = sq / 8, fl = sq % 8, r, f;
 
@@ -60,19 +62,19 @@ static inline uint64_t batt(int sq, uint64_t block) {
 }
 
 // Compiler-specific bit manipulation functions
-#ifdef __clang__
-    // Clang/LLVM specific bit counting
-    static inline int countOnes(uint64_t b) {
+#if defined(__clang__) || defined(__GNUC__)
+    // Clang/LLVM and GCC specific bit counting
+    inline int countOnes(uint64_t b) {
         return __builtin_popcountll(b);
     }
 
     // Find first set bit (returns 0-63, undefined for b==0)
-    static inline int getFirstBit(uint64_t b) {
+    inline int getFirstBit(uint64_t b) {
         return __builtin_ctzll(b);
     }
 #else
     // Fallback bit counting implementation
-    static inline int countOnes(uint64_t b) {
+    inline int countOnes(uint64_t b) {
         int r = 0;
         while (b) {
             r++;
@@ -82,7 +84,7 @@ static inline uint64_t batt(int sq, uint64_t block) {
     }
 
     // Fallback first bit implementation
-    static inline int getFirstBit(uint64_t b) {
+    inline int getFirstBit(uint64_t b) {
         const int BitTable[64] = {
             63, 30, 3, 32, 25, 41, 22, 33, 15, 50, 42, 13, 11, 53, 19, 34,
             61, 29, 2, 51, 21, 43, 45, 10, 18, 47, 1, 54, 9, 57, 0, 35,
@@ -95,7 +97,7 @@ static inline uint64_t batt(int sq, uint64_t block) {
 #endif
 
 // Convert index to bitboard configuration
-static inline uint64_t indexToUint64(int index, int bits, uint64_t m) {
+inline uint64_t indexToUint64(int index, int bits, uint64_t m) {
     uint64_t result = 0ULL;
     for (int i = 0; i < bits; i++) {
         uint64_t least_bit = m & -m;  // get least significant bit
@@ -123,12 +125,12 @@ static inline uint64_t indexToUint64(int index, int bits, uint64_t m) {
 #define SOUTH_EAST(bb) (((bb) & ~0x8080808080808080ULL) >> 7)
 #define SOUTH_WEST(bb) (((bb) & ~0x0101010101010101ULL) >> 9)
 
-// Pawn attack macros
+// Pawn attack macros, for a whole set of pawns at once (AttackTables.h has them per square)
 #define WHITE_PAWN_ATTACKS(pawns) (NORTH_EAST(pawns) | NORTH_WEST(pawns))
 #define BLACK_PAWN_ATTACKS(pawns) (SOUTH_EAST(pawns) | SOUTH_WEST(pawns))
 
 // Size of attack tables for each square
-const int RAttackSize[64] = {
+constexpr int RAttackSize[64] = {
   4096,
   2048,
   2048,
@@ -195,7 +197,7 @@ const int RAttackSize[64] = {
   4096,
 };
 
-const int BAttackSize[64] = {
+constexpr int BAttackSize[64] = {
   64,
   32,
   32,
@@ -262,9 +264,21 @@ const int BAttackSize[64] = {
   64,
 };
 
-// Attack lookup tables
-static uint64_t* RAttacks[64];
-static uint64_t* BAttacks[64];
+// Total entries across every square's table
+constexpr int totalAttackSize(const int (&sizes)[64]) {
+    int total = 0;
+    for (int square = 0; square < 64; square++) {
+        total += sizes[square];
+    }
+    return total;
+}
+
+// Attack lookup tables: one static block per piece with every square's slice packed in order,
+// shared by every translation unit and filled in once by initMagicBitboards
+inline uint64_t RAttackTable[totalAttackSize(RAttackSize)];
+inline uint64_t BAttackTable[totalAttackSize(BAttackSize)];
+inline uint64_t* RAttacks[64];
+inline uint64_t* BAttacks[64];
 
 // Magic bitboard shift amounts
 const int RShifts[64] = {
@@ -672,171 +686,34 @@ const uint64_t BMasks[64] = {
   0x40201008040200ULL,
 };
 
-// Pre-calculated knight attack bitboards
-const uint64_t KnightAttacks[64] = {
-  0x20400ULL,
-  0x50800ULL,
-  0xa1100ULL,
-  0x142200ULL,
-  0x284400ULL,
-  0x508800ULL,
-  0xa01000ULL,
-  0x402000ULL,
-  0x2040004ULL,
-  0x5080008ULL,
-  0xa110011ULL,
-  0x14220022ULL,
-  0x28440044ULL,
-  0x50880088ULL,
-  0xa0100010ULL,
-  0x40200020ULL,
-  0x204000402ULL,
-  0x508000805ULL,
-  0xa1100110aULL,
-  0x1422002214ULL,
-  0x2844004428ULL,
-  0x5088008850ULL,
-  0xa0100010a0ULL,
-  0x4020002040ULL,
-  0x20400040200ULL,
-  0x50800080500ULL,
-  0xa1100110a00ULL,
-  0x142200221400ULL,
-  0x284400442800ULL,
-  0x508800885000ULL,
-  0xa0100010a000ULL,
-  0x402000204000ULL,
-  0x2040004020000ULL,
-  0x5080008050000ULL,
-  0xa1100110a0000ULL,
-  0x14220022140000ULL,
-  0x28440044280000ULL,
-  0x50880088500000ULL,
-  0xa0100010a00000ULL,
-  0x40200020400000ULL,
-  0x204000402000000ULL,
-  0x508000805000000ULL,
-  0xa1100110a000000ULL,
-  0x1422002214000000ULL,
-  0x2844004428000000ULL,
-  0x5088008850000000ULL,
-  0xa0100010a0000000ULL,
-  0x4020002040000000ULL,
-  0x400040200000000ULL,
-  0x800080500000000ULL,
-  0x1100110a00000000ULL,
-  0x2200221400000000ULL,
-  0x4400442800000000ULL,
-  0x8800885000000000ULL,
-  0x100010a000000000ULL,
-  0x2000204000000000ULL,
-  0x4020000000000ULL,
-  0x8050000000000ULL,
-  0x110a0000000000ULL,
-  0x22140000000000ULL,
-  0x44280000000000ULL,
-  0x88500000000000ULL,
-  0x10a00000000000ULL,
-  0x20400000000000ULL,
-};
-
-// Pre-calculated king attack bitboards
-const uint64_t KingAttacks[64] = {
-  0x302ULL,
-  0x705ULL,
-  0xe0aULL,
-  0x1c14ULL,
-  0x3828ULL,
-  0x7050ULL,
-  0xe0a0ULL,
-  0xc040ULL,
-  0x30203ULL,
-  0x70507ULL,
-  0xe0a0eULL,
-  0x1c141cULL,
-  0x382838ULL,
-  0x705070ULL,
-  0xe0a0e0ULL,
-  0xc040c0ULL,
-  0x3020300ULL,
-  0x7050700ULL,
-  0xe0a0e00ULL,
-  0x1c141c00ULL,
-  0x38283800ULL,
-  0x70507000ULL,
-  0xe0a0e000ULL,
-  0xc040c000ULL,
-  0x302030000ULL,
-  0x705070000ULL,
-  0xe0a0e0000ULL,
-  0x1c141c0000ULL,
-  0x3828380000ULL,
-  0x7050700000ULL,
-  0xe0a0e00000ULL,
-  0xc040c00000ULL,
-  0x30203000000ULL,
-  0x70507000000ULL,
-  0xe0a0e000000ULL,
-  0x1c141c000000ULL,
-  0x382838000000ULL,
-  0x705070000000ULL,
-  0xe0a0e0000000ULL,
-  0xc040c0000000ULL,
-  0x3020300000000ULL,
-  0x7050700000000ULL,
-  0xe0a0e00000000ULL,
-  0x1c141c00000000ULL,
-  0x38283800000000ULL,
-  0x70507000000000ULL,
-  0xe0a0e000000000ULL,
-  0xc040c000000000ULL,
-  0x302030000000000ULL,
-  0x705070000000000ULL,
-  0xe0a0e0000000000ULL,
-  0x1c141c0000000000ULL,
-  0x3828380000000000ULL,
-  0x7050700000000000ULL,
-  0xe0a0e00000000000ULL,
-  0xc040c00000000000ULL,
-  0x203000000000000ULL,
-  0x507000000000000ULL,
-  0xa0e000000000000ULL,
-  0x141c000000000000ULL,
-  0x2838000000000000ULL,
-  0x5070000000000000ULL,
-  0xa0e0000000000000ULL,
-  0x40c0000000000000ULL,
-};
-
 // Helper functions for move generation
-static inline uint64_t getRookAttacks(int square, uint64_t occupied) {
+inline uint64_t getRookAttacks(int square, uint64_t occupied) {
     occupied &= RMasks[square];
     occupied *= RMagic[square];
     occupied >>= RShifts[square];
     return RAttacks[square][occupied];
 }
 
-static inline uint64_t getBishopAttacks(int square, uint64_t occupied) {
+inline uint64_t getBishopAttacks(int square, uint64_t occupied) {
     occupied &= BMasks[square];
     occupied *= BMagic[square];
     occupied >>= BShifts[square];
     return BAttacks[square][occupied];
 }
 
-static inline uint64_t getQueenAttacks(int square, uint64_t occupied) {
+inline uint64_t getQueenAttacks(int square, uint64_t occupied) {
     return getRookAttacks(square, occupied) | getBishopAttacks(square, occupied);
 }
 
-/*
-
-// Initialize magic bitboards
-void initMagicBitboards(void) {
+// Build the magic attack tables, only called once through initMagicBitboards()
+inline bool buildMagicBitboards(void) {
     int square, i;
     uint64_t subset, index;
+    int offset;
 
     // Initialize rook attack tables
-    for (square = 0; square < 64; square++) {
-        RAttacks[square] = new uint64_t[RAttackSize[square]];
+    for (square = 0, offset = 0; square < 64; offset += RAttackSize[square], square++) {
+        RAttacks[square] = RAttackTable + offset;
         uint64_t mask = RMasks[square];
         int bits = countOnes(mask);
         int n = 1 << bits;
@@ -849,8 +726,8 @@ void initMagicBitboards(void) {
     }
 
     // Initialize bishop attack tables
-    for (square = 0; square < 64; square++) {
-        BAttacks[square] = new uint64_t[BAttackSize[square]];
+    for (square = 0, offset = 0; square < 64; offset += BAttackSize[square], square++) {
+        BAttacks[square] = BAttackTable + offset;
         uint64_t mask = BMasks[square];
         int bits = countOnes(mask);
         int n = 1 << bits;
@@ -861,17 +738,38 @@ void initMagicBitboards(void) {
             BAttacks[square][index] = batt(square, subset);
         }
     }
+    return true;
 }
 
-// Cleanup magic bitboard tables
-void cleanupMagicBitboards(void) {
-    int square;
+// Initialize magic bitboards
+// safe to call from every game instance and every thread: this is a plain inline function, so the whole
+// program shares one guard and the tables are only built the first time
+inline void initMagicBitboards(void) {
+    static const bool initialized = buildMagicBitboards();
+    (void)initialized;
+}
+
+// Check the magic lookups against the loop based ratt()/batt() for every square and every
+// blocker subset of its mask. returns the number of mismatches, 0 means the tables are good
+inline int verifyMagicBitboards(void) {
+    int square, i;
+    int errors = 0;
+
+    initMagicBitboards();
     for (square = 0; square < 64; square++) {
-        delete[] RAttacks[square];
-        delete[] BAttacks[square];
+        int bits = countOnes(RMasks[square]);
+        for (i = 0; i < (1 << bits); i++) {
+            uint64_t subset = indexToUint64(i, bits, RMasks[square]);
+            if (getRookAttacks(square, subset) != ratt(square, subset)) errors++;
+        }
+
+        bits = countOnes(BMasks[square]);
+        for (i = 0; i < (1 << bits); i++) {
+            uint64_t subset = indexToUint64(i, bits, BMasks[square]);
+            if (getBishopAttacks(square, subset) != batt(square, subset)) errors++;
+        }
     }
+    return errors;
 }
 
-*/
-
 #endif // MAGIC_BITBOARDS_H
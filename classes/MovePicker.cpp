@@ -0,0 +1,166 @@
+#include "MovePicker.h"
+#include "ChessEval.h"
+
+#include <utility>
+
+MovePicker::MovePicker(const ChessPosition& position, MoveList& moves, int* scores, BitMove ttMove,
+                       const BitMove* killers, const int (*history)[64][64], bool tacticalOnly)
+    : _position(position), _moves(moves), _scores(scores), _ttMove(ttMove), _killers(killers),
+      _history(history), _tacticalOnly(tacticalOnly), _stage(StageHashMove), _index(0), _killerIndex(0),
+      _tacticalEnd(0), _badIndex(0)
+{
+    _moves.clear();
+    // the hash move came from another position that happened to share a table slot, make sure it fits here
+    if (_ttMove.isNull() || (_tacticalOnly && !_ttMove.isCapture() && !_ttMove.isPromotion())
+        || !_position.isLegalMove(_ttMove)) {
+        _ttMove = BitMove();
+    }
+}
+
+BitMove MovePicker::next()
+{
+    switch (_stage) {
+    case StageHashMove:
+        _stage = StageGenerateTactical;
+        if (!_ttMove.isNull()) {
+            return _ttMove;
+        }
+        [[fallthrough]];
+
+    case StageGenerateTactical:
+        _position.generateLegalMoves(_moves, GenTactical);
+        scoreTactical();
+        _index = 0;
+        _tacticalEnd = _moves.size();
+        _badIndex = _tacticalEnd;
+        _stage = StageTactical;
+        [[fallthrough]];
+
+    case StageTactical:
+        while (_index < _badIndex) {
+            pickBest(_index, _badIndex);
+            BitMove move = _moves[_index];
+            int exchange;
+            if (!(move == _ttMove) && losesMaterial(move, exchange)) {
+                // losing captures go to the back of the tactical moves and wait until after the quiet moves
+                _badIndex--;
+                std::swap(_moves[_index], _moves[_badIndex]);
+                _scores[_index] = _scores[_badIndex];
+                _scores[_badIndex] = exchange;
+                continue;
+            }
+            _index++;
+            if (!(move == _ttMove)) {
+                return move;
+            }
+        }
+        if (_tacticalOnly) {
+            _stage = StageDone;
+            return BitMove();
+        }
+        _stage = StageKillers;
+        [[fallthrough]];
+
+    case StageKillers:
+        // killers are quiet moves that cut off at this ply somewhere else in the tree,
+        // the flags have to match too, so one that would capture here is skipped
+        while (_killers && _killerIndex < 2) {
+            BitMove killer = _killers[_killerIndex++];
+            if (!killer.isNull() && !(killer == _ttMove) && _position.isLegalMove(killer)) {
+                return killer;
+            }
+        }
+        _stage = StageGenerateQuiet;
+        [[fallthrough]];
+
+    case StageGenerateQuiet:
+        _index = _moves.size();
+        _position.generateLegalMoves(_moves, GenQuiet);
+        scoreQuiet();
+        _stage = StageQuiet;
+        [[fallthrough]];
+
+    case StageQuiet:
+        while (_index < _moves.size()) {
+            pickBest(_index, _moves.size());
+            BitMove move = _moves[_index++];
+            if (!(move == _ttMove) && !isKiller(move)) {
+                return move;
+            }
+        }
+        _stage = StageBadTactical;
+        [[fallthrough]];
+
+    case StageBadTactical:
+        while (_badIndex < _tacticalEnd) {
+            pickBest(_badIndex, _tacticalEnd);
+            BitMove move = _moves[_badIndex++];
+            if (!(move == _ttMove)) {
+                return move;
+            }
+        }
+        _stage = StageDone;
+        [[fallthrough]];
+
+    case StageDone:
+        break;
+    }
+    return BitMove();
+}
+
+// most valuable victim first, least valuable attacker breaking ties, promotions by the piece they make
+void MovePicker::scoreTactical()
+{
+    for (int i = 0; i < _moves.size(); i++) {
+        BitMove move = _moves[i];
+        int score = 0;
+        if (move.isCapture()) {
+            ChessPiece victim = move.isEnPassant() ? Pawn : _position.pieceAt(move.to());
+            score = PieceValues[victim] * 10 - PieceValues[_position.pieceAt(move.from())] / 10;
+        }
+        if (move.isPromotion()) {
+            score += PieceValues[move.promotionPiece()];
+        }
+        _scores[i] = score;
+    }
+}
+
+// the static exchange is only worked out for a move that's about to be played, a cutoff usually comes
+// first, and taking something worth at least as much as the attacker can't lose material anyway
+bool MovePicker::losesMaterial(BitMove move, int& exchange) const
+{
+    ChessPiece victim = move.isEnPassant() ? Pawn : _position.pieceAt(move.to());
+    if (!move.isPromotion() && PieceValues[victim] >= PieceValues[_position.pieceAt(move.from())]) {
+        return false;
+    }
+    exchange = staticExchange(_position, move);
+    return exchange < 0;
+}
+
+void MovePicker::scoreQuiet()
+{
+    int color = _position.sideToMove();
+    for (int i = _index; i < _moves.size(); i++) {
+        _scores[i] = _history ? _history[color][_moves[i].from()][_moves[i].to()] : 0;
+    }
+}
+
+// selection sort one step at a time, most nodes cut off long before the list is sorted
+void MovePicker::pickBest(int index, int end)
+{
+    int best = index;
+    for (int i = index + 1; i < end; i++) {
+        if (_scores[i] > _scores[best]) {
+            best = i;
+        }
+    }
+    if (best != index) {
+        std::swap(_moves[index], _moves[best]);
+        std::swap(_scores[index], _scores[best]);
+    }
+}
+
+bool MovePicker::isKiller(BitMove move) const
+{
+    return _killers && (move == _killers[0] || move == _killers[1]);
+}
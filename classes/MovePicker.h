@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ChessPosition.h"
+
+//
+// hands the search its moves one at a time, generating each group only when the last one runs out:
+// the hash move, captures and promotions that don't lose material (by most valuable victim / least
+// valuable attacker), the killer moves, the rest of the quiet moves by history score, and last the
+// captures the static exchange says lose material
+// most nodes cut off within the first couple of moves, so the quiet moves are often never generated at all
+//
+
+// history scores stay within +-HistoryMax
+constexpr int HistoryMax = 16384;
+
+class MovePicker
+{
+public:
+    // moves and scores are the caller's scratch space for this ply, history is [color][from][to]
+    // killers (two of them) and history can be null when there are none, as in the quiescence search
+    // tacticalOnly leaves out the quiet moves and the losing captures, the quiescence search doesn't want either
+    MovePicker(const ChessPosition& position, MoveList& moves, int* scores, BitMove ttMove,
+               const BitMove* killers, const int (*history)[64][64], bool tacticalOnly);
+
+    // the next move to search, a null move (from == to) once there are none left
+    BitMove next();
+
+private:
+    enum Stage
+    {
+        StageHashMove,
+        StageGenerateTactical,
+        StageTactical,
+        StageKillers,
+        StageGenerateQuiet,
+        StageQuiet,
+        StageBadTactical,
+        StageDone
+    };
+
+    void scoreTactical();
+    void scoreQuiet();
+    // swap the best scored move in [index, end) into index
+    void pickBest(int index, int end);
+    bool losesMaterial(BitMove move, int& exchange) const;
+    bool isKiller(BitMove move) const;
+
+    const ChessPosition& _position;
+    MoveList& _moves;
+    int* _scores;
+    BitMove _ttMove;
+    const BitMove* _killers;
+    const int (*_history)[64][64];
+    bool _tacticalOnly;
+
+    Stage _stage;
+    int _index;
+    int _killerIndex;
+    // the tactical moves are [0, _tacticalEnd), any found to lose material are moved back to [_badIndex, _tacticalEnd)
+    int _tacticalEnd;
+    int _badIndex;
+};
@@ -0,0 +1,366 @@
+#include "Nnue.h"
+
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if !defined(NNUE_NO_SIMD) && defined(__AVX2__)
+#define NNUE_AVX2
+#include <immintrin.h>
+#elif !defined(NNUE_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NNUE_SSE2
+#include <emmintrin.h>
+#endif
+
+#pragma region KERNELS
+
+// accumulator += weights, for one feature
+static inline void addFeature(int16_t* accumulator, const int16_t* weights)
+{
+#if defined(NNUE_AVX2)
+    for (int i = 0; i < NnueHalfDimensions; i += 16) {
+        __m256i a = _mm256_load_si256((const __m256i*)(accumulator + i));
+        __m256i w = _mm256_loadu_si256((const __m256i*)(weights + i));
+        _mm256_store_si256((__m256i*)(accumulator + i), _mm256_add_epi16(a, w));
+    }
+#elif defined(NNUE_SSE2)
+    for (int i = 0; i < NnueHalfDimensions; i += 8) {
+        __m128i a = _mm_load_si128((const __m128i*)(accumulator + i));
+        __m128i w = _mm_loadu_si128((const __m128i*)(weights + i));
+        _mm_store_si128((__m128i*)(accumulator + i), _mm_add_epi16(a, w));
+    }
+#else
+    for (int i = 0; i < NnueHalfDimensions; i++) {
+        accumulator[i] += weights[i];
+    }
+#endif
+}
+
+static inline void subFeature(int16_t* accumulator, const int16_t* weights)
+{
+#if defined(NNUE_AVX2)
+    for (int i = 0; i < NnueHalfDimensions; i += 16) {
+        __m256i a = _mm256_load_si256((const __m256i*)(accumulator + i));
+        __m256i w = _mm256_loadu_si256((const __m256i*)(weights + i));
+        _mm256_store_si256((__m256i*)(accumulator + i), _mm256_sub_epi16(a, w));
+    }
+#elif defined(NNUE_SSE2)
+    for (int i = 0; i < NnueHalfDimensions; i += 8) {
+        __m128i a = _mm_load_si128((const __m128i*)(accumulator + i));
+        __m128i w = _mm_loadu_si128((const __m128i*)(weights + i));
+        _mm_store_si128((__m128i*)(accumulator + i), _mm_sub_epi16(a, w));
+    }
+#else
+    for (int i = 0; i < NnueHalfDimensions; i++) {
+        accumulator[i] -= weights[i];
+    }
+#endif
+}
+
+// int16 accumulator clipped to 0..127 and narrowed to bytes
+static inline void clipAccumulator(const int16_t* input, uint8_t* output)
+{
+#if defined(NNUE_AVX2)
+    const __m256i top = _mm256_set1_epi16(127);
+    for (int i = 0; i < NnueHalfDimensions; i += 32) {
+        __m256i a = _mm256_min_epi16(_mm256_load_si256((const __m256i*)(input + i)), top);
+        __m256i b = _mm256_min_epi16(_mm256_load_si256((const __m256i*)(input + i + 16)), top);
+        // packus saturates negatives to 0, but works per 128 bit lane, so put the quarters back in order
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i*)(output + i), packed);
+    }
+#elif defined(NNUE_SSE2)
+    const __m128i top = _mm_set1_epi16(127);
+    for (int i = 0; i < NnueHalfDimensions; i += 16) {
+        __m128i a = _mm_min_epi16(_mm_load_si128((const __m128i*)(input + i)), top);
+        __m128i b = _mm_min_epi16(_mm_load_si128((const __m128i*)(input + i + 8)), top);
+        _mm_storeu_si128((__m128i*)(output + i), _mm_packus_epi16(a, b));
+    }
+#else
+    for (int i = 0; i < NnueHalfDimensions; i++) {
+        int16_t value = input[i];
+        output[i] = (uint8_t)(value < 0 ? 0 : (value > 127 ? 127 : value));
+    }
+#endif
+}
+
+// sum of input[i] * weights[i], count is a multiple of 32, inputs are 0..127 so the int16 pair sums can't overflow
+static inline int32_t dotProduct(const uint8_t* input, const int8_t* weights, int count)
+{
+#if defined(NNUE_AVX2)
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < count; i += 32) {
+        __m256i in = _mm256_loadu_si256((const __m256i*)(input + i));
+        __m256i w = _mm256_loadu_si256((const __m256i*)(weights + i));
+        __m256i pairs = _mm256_maddubs_epi16(in, w);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(pairs, ones));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+#elif defined(NNUE_SSE2)
+    // no byte multiply before SSSE3, so widen both sides to int16 and use madd
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < count; i += 16) {
+        __m128i in = _mm_loadu_si128((const __m128i*)(input + i));
+        __m128i w = _mm_loadu_si128((const __m128i*)(weights + i));
+        __m128i inLow = _mm_unpacklo_epi8(in, zero);
+        __m128i inHigh = _mm_unpackhi_epi8(in, zero);
+        __m128i wLow = _mm_srai_epi16(_mm_unpacklo_epi8(w, w), 8);
+        __m128i wHigh = _mm_srai_epi16(_mm_unpackhi_epi8(w, w), 8);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(inLow, wLow));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(inHigh, wHigh));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += input[i] * weights[i];
+    }
+    return sum;
+#endif
+}
+
+// a dense layer followed by the clipped relu, outputs back down to 0..127
+static inline void hiddenLayer(const uint8_t* input, int inputs, const int8_t* weights, const int32_t* biases,
+                               uint8_t* output, int outputs)
+{
+    for (int i = 0; i < outputs; i++) {
+        int32_t value = (biases[i] + dotProduct(input, weights + i * inputs, inputs)) >> NnueWeightScaleBits;
+        output[i] = (uint8_t)(value < 0 ? 0 : (value > 127 ? 127 : value));
+    }
+}
+
+#pragma endregion
+
+#pragma region NETWORK
+
+NnueNetwork::NnueNetwork()
+    : _mapping(nullptr), _mappingSize(0),
+#if defined(_WIN32)
+      _fileHandle(nullptr), _mappingHandle(nullptr),
+#endif
+      _featureBiases(nullptr), _featureWeights(nullptr), _layer1Biases(nullptr), _layer1Weights(nullptr),
+      _layer2Biases(nullptr), _layer2Weights(nullptr), _outputBias(nullptr), _outputWeights(nullptr)
+{
+}
+
+NnueNetwork::~NnueNetwork()
+{
+    unload();
+}
+
+static size_t alignUp(size_t offset)
+{
+    return (offset + 63) & ~(size_t)63;
+}
+
+bool NnueNetwork::load(const std::string& path)
+{
+    unload();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    void* view = nullptr;
+    if (GetFileSizeEx(file, &size)) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (mapping) {
+        view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    _fileHandle = file;
+    _mappingHandle = mapping;
+    _mapping = view;
+    _mappingSize = (size_t)size.QuadPart;
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat info;
+    void* view = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+        view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file); // the mapping keeps the file open
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    _mapping = view;
+    _mappingSize = (size_t)info.st_size;
+#endif
+
+    // check the header, then lay the arrays out over the mapping
+    const uint8_t* base = (const uint8_t*)_mapping;
+    uint32_t header[4];
+    if (_mappingSize < 20 || std::memcmp(base, "CBNN", 4) != 0) {
+        unload();
+        return false;
+    }
+    std::memcpy(header, base + 4, sizeof(header));
+    if (header[0] != NnueVersion || header[1] != (uint32_t)NnueInputs || header[2] != (uint32_t)NnueHalfDimensions
+        || header[3] != (uint32_t)NnueHidden) {
+        unload();
+        return false;
+    }
+
+    size_t offset = 20;
+    auto take = [&] (size_t bytes) {
+        offset = alignUp(offset);
+        const uint8_t* start = base + offset;
+        offset += bytes;
+        return start;
+    };
+    _featureBiases = (const int16_t*)take(sizeof(int16_t) * NnueHalfDimensions);
+    _featureWeights = (const int16_t*)take(sizeof(int16_t) * (size_t)NnueInputs * NnueHalfDimensions);
+    _layer1Biases = (const int32_t*)take(sizeof(int32_t) * NnueHidden);
+    _layer1Weights = (const int8_t*)take((size_t)NnueHidden * NnueHalfDimensions * 2);
+    _layer2Biases = (const int32_t*)take(sizeof(int32_t) * NnueHidden);
+    _layer2Weights = (const int8_t*)take((size_t)NnueHidden * NnueHidden);
+    _outputBias = (const int32_t*)take(sizeof(int32_t));
+    _outputWeights = (const int8_t*)take(NnueHidden);
+
+    if (offset > _mappingSize) {
+        unload();
+        return false;
+    }
+    return true;
+}
+
+void NnueNetwork::unload()
+{
+    if (_mapping) {
+#if defined(_WIN32)
+        UnmapViewOfFile(_mapping);
+        CloseHandle((HANDLE)_mappingHandle);
+        CloseHandle((HANDLE)_fileHandle);
+        _mappingHandle = nullptr;
+        _fileHandle = nullptr;
+#else
+        munmap(_mapping, _mappingSize);
+#endif
+    }
+    _mapping = nullptr;
+    _mappingSize = 0;
+    _featureBiases = _featureWeights = nullptr;
+    _layer1Biases = _layer2Biases = _outputBias = nullptr;
+    _layer1Weights = _layer2Weights = _outputWeights = nullptr;
+}
+
+// kings aren't inputs themselves, they pick which set of weights the other pieces use
+int NnueNetwork::featureIndex(int perspective, int kingSquare, int color, ChessPiece piece, int square) const
+{
+    if (perspective == BLACK) {
+        kingSquare ^= 56;
+        square ^= 56;
+    }
+    int pieceIndex = (piece - Pawn) * 2 + (color != perspective);
+    return kingSquare * NnuePieceFeatures + 1 + pieceIndex * 64 + square;
+}
+
+void NnueNetwork::refresh(const ChessPosition& position, NnueAccumulator& accumulator, int perspective) const
+{
+    int16_t* values = accumulator.values[perspective];
+    std::memcpy(values, _featureBiases, sizeof(int16_t) * NnueHalfDimensions);
+
+    int king = position.kingSquare(perspective);
+    for (int color = WHITE; color <= BLACK; color++) {
+        for (int piece = Pawn; piece < King; piece++) {
+            BitboardElement(position.pieces(color, ChessPiece(piece))).forEachBit([&] (int square) {
+                int index = featureIndex(perspective, king, color, ChessPiece(piece), square);
+                addFeature(values, _featureWeights + (size_t)index * NnueHalfDimensions);
+            });
+        }
+    }
+    accumulator.computed[perspective] = true;
+}
+
+void NnueNetwork::update(const ChessPosition& position, BitMove move, const NnueAccumulator& parent, NnueAccumulator& child) const
+{
+    int us = position.sideToMove();
+    int from = move.from();
+    int to = move.to();
+    ChessPiece moved = position.pieceAt(from);
+    ChessPiece placed = move.isPromotion() ? move.promotionPiece() : moved;
+    int captureSquare = move.isEnPassant() ? (us == WHITE ? to - 8 : to + 8) : to;
+    ChessPiece captured = move.isCapture() ? (move.isEnPassant() ? Pawn : position.pieceAt(to)) : NoPiece;
+
+    for (int perspective = WHITE; perspective <= BLACK; perspective++) {
+        // our own king moving changes every feature on our side, that gets rebuilt once the move is made
+        if ((moved == King && perspective == us) || !parent.computed[perspective]) {
+            child.computed[perspective] = false;
+            continue;
+        }
+
+        int16_t* values = child.values[perspective];
+        std::memcpy(values, parent.values[perspective], sizeof(int16_t) * NnueHalfDimensions);
+        int king = position.kingSquare(perspective);
+        auto weights = [&] (int color, ChessPiece piece, int square) {
+            return _featureWeights + (size_t)featureIndex(perspective, king, color, piece, square) * NnueHalfDimensions;
+        };
+
+        if (moved != King) {
+            subFeature(values, weights(us, moved, from));
+            addFeature(values, weights(us, placed, to));
+        }
+        if (captured != NoPiece) {
+            subFeature(values, weights(us ^ 1, captured, captureSquare));
+        }
+        if (move.isCastle()) {
+            int base = to & 56;
+            bool kingside = move.flags() == MoveKingCastle;
+            subFeature(values, weights(us, Rook, kingside ? base + 7 : base));
+            addFeature(values, weights(us, Rook, kingside ? base + 5 : base + 3));
+        }
+        child.computed[perspective] = true;
+    }
+}
+
+int NnueNetwork::evaluate(const ChessPosition& position, NnueAccumulator& accumulator) const
+{
+    for (int perspective = WHITE; perspective <= BLACK; perspective++) {
+        if (!accumulator.computed[perspective]) {
+            refresh(position, accumulator, perspective);
+        }
+    }
+
+    // the side to move's half goes first, so the network always sees the position from the mover's side
+    int us = position.sideToMove();
+    alignas(64) uint8_t input[NnueHalfDimensions * 2];
+    clipAccumulator(accumulator.values[us], input);
+    clipAccumulator(accumulator.values[us ^ 1], input + NnueHalfDimensions);
+
+    alignas(64) uint8_t hidden1[NnueHidden];
+    alignas(64) uint8_t hidden2[NnueHidden];
+    hiddenLayer(input, NnueHalfDimensions * 2, _layer1Weights, _layer1Biases, hidden1, NnueHidden);
+    hiddenLayer(hidden1, NnueHidden, _layer2Weights, _layer2Biases, hidden2, NnueHidden);
+
+    int32_t output = _outputBias[0] + dotProduct(hidden2, _outputWeights, NnueHidden);
+    return output / NnueOutputScale;
+}
+
+#pragma endregion
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ChessPosition.h"
+
+#include <stdint.h>
+#include <string>
+
+//
+// efficiently updatable neural network evaluation (NNUE) with HalfKP inputs
+//
+//   inputs:  for each side, its king square x every other piece (type, color relative to that side, square)
+//            64 x 641 features, of which only the ~30 pieces on the board are ever active
+//   layer 0: 41024 -> 256 per side, int16, kept as an accumulator that make/unmake only nudges
+//   layer 1: 512 (side to move's half first) -> 32, int8 weights on inputs clipped to 0..127
+//   layer 2: 32 -> 32, same again
+//   output:  32 -> 1, divided by NnueOutputScale to get centipawns for the side to move
+//
+// the weights are memory mapped straight out of the file and shared read-only by every search thread
+// the kernels use AVX2 or SSE2 when the compiler targets them (define NNUE_NO_SIMD to force the scalar ones)
+//
+// file layout, little endian, every array starting on a 64 byte boundary from the start of the file:
+//   header   char magic[4] "CBNN", uint32 version (1), uint32 inputs, uint32 half dimensions, uint32 hidden
+//   int16 feature biases[256], int16 feature weights[41024][256]
+//   int32 layer 1 biases[32],  int8 layer 1 weights[32][512]
+//   int32 layer 2 biases[32],  int8 layer 2 weights[32][32]
+//   int32 output bias[1],      int8 output weights[32]
+// squares are 0 = a1 .. 63 = h8, black's view is flipped top to bottom (square ^ 56) so both sides see
+// their own pieces from the first row
+//
+
+constexpr int NnueKingSquares = 64;
+constexpr int NnuePieceFeatures = 10 * 64 + 1;     // 5 piece types x 2 colors x 64 squares, plus one unused
+constexpr int NnueInputs = NnueKingSquares * NnuePieceFeatures;
+constexpr int NnueHalfDimensions = 256;
+constexpr int NnueHidden = 32;
+constexpr int NnueWeightScaleBits = 6;              // hidden layer outputs are shifted down by this much
+constexpr int NnueOutputScale = 16;
+constexpr uint32_t NnueVersion = 1;
+
+// the first layer's output for both sides, one of these per ply in the search
+struct alignas(64) NnueAccumulator {
+    int16_t values[2][NnueHalfDimensions];
+    // false after a king move, that side gets rebuilt from the board when it's next evaluated
+    bool computed[2];
+};
+
+class NnueNetwork
+{
+public:
+    NnueNetwork();
+    ~NnueNetwork();
+    NnueNetwork(const NnueNetwork&) = delete;
+    NnueNetwork& operator=(const NnueNetwork&) = delete;
+
+    // map a network file, anything already loaded is dropped first
+    // returns false (and leaves nothing loaded) if the file is missing or isn't a network this build understands
+    bool load(const std::string& path);
+    void unload();
+    bool loaded() const { return _mapping != nullptr; }
+
+    // build one side of the accumulator from scratch
+    void refresh(const ChessPosition& position, NnueAccumulator& accumulator, int perspective) const;
+    // child becomes parent with move applied, position is the board BEFORE the move is made
+    // a king move leaves the mover's side of child stale, refresh it once the move is made
+    // (evaluate would, but every node under it would then be rebuilding it again)
+    void update(const ChessPosition& position, BitMove move, const NnueAccumulator& parent, NnueAccumulator& child) const;
+    // centipawns for the side to move, rebuilding any side a king move left stale
+    int evaluate(const ChessPosition& position, NnueAccumulator& accumulator) const;
+
+private:
+    int featureIndex(int perspective, int kingSquare, int color, ChessPiece piece, int square) const;
+
+    // the mapped file
+    void* _mapping;
+    size_t _mappingSize;
+#if defined(_WIN32)
+    void* _fileHandle;
+    void* _mappingHandle;
+#endif
+
+    // pointers into the mapping
+    const int16_t* _featureBiases;
+    const int16_t* _featureWeights;
+    const int32_t* _layer1Biases;
+    const int8_t* _layer1Weights;
+    const int32_t* _layer2Biases;
+    const int8_t* _layer2Weights;
+    const int32_t* _outputBias;
+    const int8_t* _outputWeights;
+};
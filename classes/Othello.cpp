@@ -49,11 +49,15 @@ void Othello::setUpBoard() {
 
 Bit* Othello::createPiece(Player* player) {
     Bit* bit = new Bit();
-    bit->LoadTextureFromFile(player == getPlayerAt(BLACK_PLAYER) ? "o.png" : "x.png");
+    bit->LoadTextureFromFile(pieceTexture(player));
     bit->setOwner(player);
     return bit;
 }
 
+const char* Othello::pieceTexture(Player* player) {
+    return player == getPlayerAt(BLACK_PLAYER) ? "o.png" : "x.png";
+}
+
 bool Othello::actionForEmptyHolder(BitHolder &holder) {
     if (holder.bit()) return false;
 
@@ -146,11 +150,11 @@ void Othello::flipInDirection(int x, int y, int dx, int dy, Player* player, int
 
     for (int i = 0; i < count; i++) {
         ChessSquare* square = _grid->getSquare(nx, ny);
+        // flip the disc in place, the texture is already in the sprite cache
         if (square && square->bit()) {
-            square->destroyBit();
-            Bit* newPiece = createPiece(player);
-            newPiece->setPosition(square->getPosition());
-            square->setBit(newPiece);
+            Bit* piece = square->bit();
+            piece->setOwner(player);
+            piece->LoadTextureFromFile(pieceTexture(player));
         }
         nx += dx;
         ny += dy;
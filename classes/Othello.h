@@ -38,6 +38,7 @@ private:
 
     // Helper methods
     Bit*        createPiece(Player* player);
+    const char* pieceTexture(Player* player);
     bool        isValidMove(int x, int y, Player* player) const;
     int         checkDirection(int x, int y, int dx, int dy, Player* player) const;
     void        flipPieces(int x, int y, Player* player);
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Bitboard.h"
+
+//
+// material and piece-square values for the evaluation: a middlegame and an endgame score for every piece
+// on every square, blended by how much material is left on the board (the game phase)
+// ChessPosition keeps running totals of both as pieces come and go, so evaluating never rescans the board
+//
+
+constexpr int MidgameValues[7] = { 0, 100, 320, 330, 500, 900, 0 };
+constexpr int EndgameValues[7] = { 0, 120, 300, 320, 520, 940, 0 };
+
+// how much each piece counts towards the phase, MaxPhase is the full set of pieces
+// (it can go over after a promotion, the evaluation caps it)
+constexpr int PhaseWeights[7] = { 0, 0, 1, 1, 2, 4, 0 };
+constexpr int MaxPhase = 24;
+
+// written the way a board is printed: row 8 at the top, a-file on the left
+// white looks squares up with square ^ 56, black uses the square as is
+inline constexpr int MidgameTables[7][64] = {
+    // no piece
+    { 0 },
+    // pawn
+    {
+         0,  0,  0,  0,  0,  0,  0,  0,
+        50, 50, 50, 50, 50, 50, 50, 50,
+        10, 10, 20, 30, 30, 20, 10, 10,
+         5,  5, 10, 25, 25, 10,  5,  5,
+         0,  0,  0, 20, 20,  0,  0,  0,
+         5, -5,-10,  0,  0,-10, -5,  5,
+         5, 10, 10,-20,-20, 10, 10,  5,
+         0,  0,  0,  0,  0,  0,  0,  0
+    },
+    // knight
+    {
+        -50,-40,-30,-30,-30,-30,-40,-50,
+        -40,-20,  0,  0,  0,  0,-20,-40,
+        -30,  0, 10, 15, 15, 10,  0,-30,
+        -30,  5, 15, 20, 20, 15,  5,-30,
+        -30,  0, 15, 20, 20, 15,  0,-30,
+        -30,  5, 10, 15, 15, 10,  5,-30,
+        -40,-20,  0,  5,  5,  0,-20,-40,
+        -50,-40,-30,-30,-30,-30,-40,-50
+    },
+    // bishop
+    {
+        -20,-10,-10,-10,-10,-10,-10,-20,
+        -10,  0,  0,  0,  0,  0,  0,-10,
+        -10,  0,  5, 10, 10,  5,  0,-10,
+        -10,  5,  5, 10, 10,  5,  5,-10,
+        -10,  0, 10, 10, 10, 10,  0,-10,
+        -10, 10, 10, 10, 10, 10, 10,-10,
+        -10,  5,  0,  0,  0,  0,  5,-10,
+        -20,-10,-10,-10,-10,-10,-10,-20
+    },
+    // rook
+    {
+         0,  0,  0,  0,  0,  0,  0,  0,
+         5, 10, 10, 10, 10, 10, 10,  5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+         0,  0,  0,  5,  5,  0,  0,  0
+    },
+    // queen
+    {
+        -20,-10,-10, -5, -5,-10,-10,-20,
+        -10,  0,  0,  0,  0,  0,  0,-10,
+        -10,  0,  5,  5,  5,  5,  0,-10,
+         -5,  0,  5,  5,  5,  5,  0, -5,
+          0,  0,  5,  5,  5,  5,  0, -5,
+        -10,  5,  5,  5,  5,  5,  0,-10,
+        -10,  0,  5,  0,  0,  0,  0,-10,
+        -20,-10,-10, -5, -5,-10,-10,-20
+    },
+    // king, tucked away behind its pawns
+    {
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -20,-30,-30,-40,-40,-30,-30,-20,
+        -10,-20,-20,-20,-20,-20,-20,-10,
+         20, 20,  0,  0,  0,  0, 20, 20,
+         20, 30, 10,  0,  0, 10, 30, 20
+    }
+};
+
+// in the endgame pawns are worth more the closer they get to promoting
+inline constexpr int PawnEndgameTable[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    80, 80, 80, 80, 80, 80, 80, 80,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    30, 30, 30, 30, 30, 30, 30, 30,
+    15, 15, 15, 15, 15, 15, 15, 15,
+     5,  5,  5,  5,  5,  5,  5,  5,
+     0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+// and the king comes out to the middle
+inline constexpr int KingEndgameTable[64] = {
+    -50,-40,-30,-20,-20,-30,-40,-50,
+    -30,-20,-10,  0,  0,-10,-20,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-30,  0,  0,  0,  0,-30,-30,
+    -50,-30,-30,-30,-30,-30,-30,-50
+};
+
+// material plus square for each color, from white's point of view (black's are negative)
+struct PieceSquareScores {
+    int midgame[2][7][64];
+    int endgame[2][7][64];
+};
+
+constexpr PieceSquareScores generatePieceSquareScores() {
+    PieceSquareScores scores{};
+    for (int piece = Pawn; piece <= King; piece++) {
+        const int* endgameTable = piece == Pawn ? PawnEndgameTable : (piece == King ? KingEndgameTable : MidgameTables[piece]);
+        for (int square = 0; square < 64; square++) {
+            scores.midgame[WHITE][piece][square] = MidgameValues[piece] + MidgameTables[piece][square ^ 56];
+            scores.endgame[WHITE][piece][square] = EndgameValues[piece] + endgameTable[square ^ 56];
+            scores.midgame[BLACK][piece][square] = -(MidgameValues[piece] + MidgameTables[piece][square]);
+            scores.endgame[BLACK][piece][square] = -(EndgameValues[piece] + endgameTable[square]);
+        }
+    }
+    return scores;
+}
+
+inline constexpr PieceSquareScores PieceSquare = generatePieceSquareScores();
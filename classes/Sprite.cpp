@@ -3,9 +3,32 @@
 #include "stb_image.h"
 #include <iostream>
 #include <filesystem>
+#include <string>
+#include <unordered_map>
+
+// every texture decoded so far, by resource name. pieces come and go all game long but there are
+// only ever a handful of images, so each one is decoded and uploaded once and kept for the life of the process
+struct CachedTexture {
+    ImTextureID texture;
+    ImVec2 size;
+};
+static std::unordered_map<std::string, CachedTexture> textureCache;
 
 // Simple helper function to load an image into a OpenGL texture with common settings
+// only the first load of each file touches the disk, after that it comes straight from the cache
 bool Sprite::LoadTextureFromFile(const char* filename)
+{
+    auto cached = textureCache.find(filename);
+    if (cached == textureCache.end()) {
+        cached = textureCache.emplace(filename, _loadTextureUncached(filename)).first;
+    }
+    _texture = cached->second.texture;
+    _size = cached->second.size;
+    return _texture != 0;
+}
+
+// a failed load is cached too (as texture 0) so a missing file is only reported once
+CachedTexture Sprite::_loadTextureUncached(const char* filename)
 {
     // Load from file
     int image_width = 0;
@@ -14,18 +37,15 @@ bool Sprite::LoadTextureFromFile(const char* filename)
     std::string newFilename = resourcePath.string();
     unsigned char* image_data = stbi_load(newFilename.c_str(), &image_width, &image_height, NULL, 4);
     if (image_data == NULL) {
-        _size = ImVec2(0, 0);
         std::cout << "Failed to load texture: " << newFilename << std::endl;
-        return false;
+        return { 0, ImVec2(0, 0) };
     }
-    _texture = _loadTextureFromMemory(image_data, image_width, image_height);
+    ImTextureID texture = _loadTextureFromMemory(image_data, image_width, image_height);
     stbi_image_free(image_data);
-    if (_texture == 0) {
-        _size = ImVec2(0, 0);
-        return false;
+    if (texture == 0) {
+        return { 0, ImVec2(0, 0) };
     }
-    _size = ImVec2((float)image_width, (float)image_height);
-    return true;
+    return { texture, ImVec2((float)image_width, (float)image_height) };
 }
 
 void Sprite::setHighlighted(bool highlighted)
@@ -2,6 +2,8 @@
 #include "Entity.h"
 #include "../imgui/imgui.h"
 
+struct CachedTexture;
+
 class Sprite : public Entity
 {
     // sprite contains code for a simple OpenGL sprite class that is heirarchical, and can be used to draw a sprite with a texture
@@ -69,12 +71,31 @@ public:
             ImGui::Image((void*)(intptr_t)_texture, _size, ImVec2(0, 0), ImVec2(1, 1), _color, highlight);
         }
     }
+    // same as above, but straight into a draw list without going through the window layout
+    // origin is where board space (0, 0) lands on screen
+    void paintSprite(ImDrawList* drawList, const ImVec2& origin)
+    {
+        if (_size.x > 0.0f && _size.y > 0.0f)
+        {
+            ImVec2 min(origin.x + _location.x, origin.y + _location.y);
+            if (_highlighted) {
+                // matches the one pixel border ImGui::Image draws around the image
+                drawList->AddRect(min, ImVec2(min.x + _size.x + 2, min.y + _size.y + 2), IM_COL32(255, 255, 0, 255));
+                min = ImVec2(min.x + 1, min.y + 1);
+            }
+            drawList->AddImage(_texture, min, ImVec2(min.x + _size.x, min.y + _size.y),
+                               ImVec2(0, 0), ImVec2(1, 1), ImGui::GetColorU32(_color));
+        }
+    }
+    ImTextureID getTexture() const { return _texture; }
+    const ImVec2 &getSize() const { return _size; }
 	// is the mouse over this position?
 	bool isMouseOver(const ImVec2 &mousePos)
     {
         return (mousePos.x >= _location.x && mousePos.x <= _location.x + _size.x && mousePos.y >= _location.y && mousePos.y <= _location.y + _size.y);
     }
 
+    // textures are shared through a process wide cache, so this is cheap after the first call per file
     bool LoadTextureFromFile(const char* filename);
 	
     // set the highlighted state
@@ -105,5 +126,6 @@ protected:
     // currently highlighted
    	bool	_highlighted;
     // private platform specific texture loading
-    ImTextureID _loadTextureFromMemory(const unsigned char *image_data, int image_width, int image_height);
+    static CachedTexture _loadTextureUncached(const char* filename);
+    static ImTextureID _loadTextureFromMemory(const unsigned char *image_data, int image_width, int image_height);
 };
@@ -0,0 +1,124 @@
+#include "TranspositionTable.h"
+
+#ifdef _MSC_VER
+#include <xmmintrin.h>
+#endif
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+    : _bucketCount(0), _generation(0)
+{
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes)
+{
+    // largest power of two number of buckets that fits, always at least one
+    size_t bytes = (megabytes ? megabytes : 1) << 20;
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= bytes) {
+        count *= 2;
+    }
+
+    if (count != _bucketCount) {
+        _buckets.reset(new Bucket[count]);
+        _bucketCount = count;
+    }
+    clear();
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i < _bucketCount; i++) {
+        for (Entry& entry : _buckets[i].entries) {
+            entry.keyXorData.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    _generation = 0;
+}
+
+uint64_t TranspositionTable::packData(BitMove move, int score, int depth, TTBound bound, int generation)
+{
+    return (uint64_t)move.packed()
+        | ((uint64_t)(uint16_t)(int16_t)score << 16)
+        | ((uint64_t)(uint8_t)(int8_t)depth << 32)
+        | ((uint64_t)bound << 40)
+        | ((uint64_t)generation << 42);
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const
+{
+    Bucket& bucket = bucketFor(key);
+    for (const Entry& slot : bucket.entries) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.keyXorData.load(std::memory_order_relaxed);
+        if ((check ^ data) == key && dataBound(data) != BoundNone) {
+            entry.move = dataMove(data);
+            entry.score = (int16_t)(data >> 16);
+            entry.depth = dataDepth(data);
+            entry.bound = dataBound(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, BitMove move, int score, int depth, TTBound bound)
+{
+    Bucket& bucket = bucketFor(key);
+
+    // reuse this position's own entry if it has one, otherwise replace the shallowest,
+    // oldest entry in the bucket (empty entries have no bound and always lose)
+    Entry* replace = &bucket.entries[0];
+    int worstValue = 1 << 30;
+    for (Entry& slot : bucket.entries) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.keyXorData.load(std::memory_order_relaxed);
+        if ((check ^ data) == key) {
+            replace = &slot;
+            // a search that didn't find a best move shouldn't wipe out the one we already know
+            if (move.isNull() && dataBound(data) != BoundNone) {
+                move = dataMove(data);
+            }
+            break;
+        }
+
+        int value = -1000;
+        if (dataBound(data) != BoundNone) {
+            int age = (_generation - dataGeneration(data)) & 63;
+            value = dataDepth(data) - 8 * age;
+        }
+        if (value < worstValue) {
+            worstValue = value;
+            replace = &slot;
+        }
+    }
+
+    uint64_t data = packData(move, score, depth, bound, _generation);
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::prefetch(uint64_t key) const
+{
+#ifdef _MSC_VER
+    _mm_prefetch((const char*)&bucketFor(key), _MM_HINT_T0);
+#else
+    __builtin_prefetch(&bucketFor(key));
+#endif
+}
+
+int TranspositionTable::hashfull() const
+{
+    size_t sample = _bucketCount < 250 ? _bucketCount : 250;
+    int used = 0;
+    for (size_t i = 0; i < sample; i++) {
+        for (const Entry& slot : _buckets[i].entries) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (dataBound(data) != BoundNone && dataGeneration(data) == _generation) {
+                used++;
+            }
+        }
+    }
+    return (int)(used * 1000 / (sample * 4));
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Bitboard.h"
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// shared transposition table for the chess search
+// a power of two number of 64 byte buckets, four 16 byte entries each, sized in megabytes at runtime
+// every entry is two 64 bit words: the packed data, and the key xor'd with that data. a probe only
+// trusts an entry when the two still xor back to the key, so search threads can probe and store at
+// the same time without locks (a torn write just reads as a miss)
+//
+
+enum TTBound : uint8_t
+{
+    BoundNone  = 0,
+    BoundUpper = 1,   // failed low, score is at most this
+    BoundLower = 2,   // failed high, score is at least this
+    BoundExact = 3
+};
+
+// what a probe hands back to the search
+struct TTEntry {
+    BitMove move;
+    int score;
+    int depth;
+    TTBound bound;
+};
+
+class TranspositionTable
+{
+public:
+    TranspositionTable(size_t megabytes = 16);
+
+    // resizing throws away everything stored, don't call it while a search is running
+    void resize(size_t megabytes);
+    void clear();
+    size_t sizeInMegabytes() const { return (_bucketCount * sizeof(Bucket)) >> 20; }
+
+    // bump the generation so entries from older searches are replaced first
+    void newSearch() { _generation = (_generation + 1) & 63; }
+
+    bool probe(uint64_t key, TTEntry& entry) const;
+    void store(uint64_t key, BitMove move, int score, int depth, TTBound bound);
+    void prefetch(uint64_t key) const;
+
+    // how full the table is, in permille (sampled from the first buckets, like UCI's hashfull)
+    int hashfull() const;
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket {
+        Entry entries[4];
+    };
+
+    static_assert(sizeof(Entry) == 16, "transposition entries should pack into 16 bytes");
+    static_assert(sizeof(Bucket) == 64, "buckets should fill exactly one cache line");
+
+    // data layout: move 0-15, score 16-31, depth 32-39, bound 40-41, generation 42-47
+    static uint64_t packData(BitMove move, int score, int depth, TTBound bound, int generation);
+    static BitMove dataMove(uint64_t data) { return BitMove::fromPacked(uint16_t(data)); }
+    static int dataDepth(uint64_t data) { return (int8_t)(data >> 32); }
+    static int dataGeneration(uint64_t data) { return (int)((data >> 42) & 63); }
+    static TTBound dataBound(uint64_t data) { return TTBound((data >> 40) & 3); }
+
+    Bucket& bucketFor(uint64_t key) const { return _buckets[key & (_bucketCount - 1)]; }
+
+    std::unique_ptr<Bucket[]> _buckets;
+    size_t _bucketCount;
+    int _generation;
+};
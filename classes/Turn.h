@@ -1,5 +1,6 @@
 #pragma once
 #include <iostream>
+#include <stdint.h>
 
 class Game;
 class Player;
@@ -14,7 +15,7 @@ typedef enum {
 class Turn
 {
 public:
-	Turn() : _game(nullptr), _player(nullptr), _status(kTurnEmpty), _move(""), _boardState(""), _date(0), _comment(""), _score(0), _replaying(false), _gameNumber(-1) {};
+	Turn() : _game(nullptr), _player(nullptr), _status(kTurnEmpty), _move(""), _boardState(""), _date(0), _comment(""), _score(0), _replaying(false), _gameNumber(-1), _positionKey(0) {};
 	~Turn() {};
 
 	static	Turn *initStartOfGame(Game *game) { Turn *turn = new Turn(); turn->_game = game; turn->_status = kTurnFinished; return turn; };
@@ -29,5 +30,6 @@ public:
 	int			_score;
 	bool		_replaying;
 	int			_gameNumber;
+	uint64_t	_positionKey;	// zobrist key for games that hash their positions, 0 otherwise
 };
 
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+//
+// zobrist keys for hashing chess positions
+// the tables are filled in at compile time from a fixed seed, so a key means the same thing
+// in every build and every process (transposition tables, opening books, saved games)
+//
+
+struct ZobristKeys {
+    uint64_t pieces[2][7][64];  // [color][piece][square], NoPiece row is left empty
+    uint64_t castling[16];      // one per combination of castling rights
+    uint64_t enPassantFile[8];
+    uint64_t sideToMove;        // xor'd in when black is to move
+};
+
+// splitmix64, small and good enough to spread the key bits
+constexpr uint64_t zobristNext(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys generateZobristKeys() {
+    ZobristKeys keys{};
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (int color = 0; color < 2; color++) {
+        for (int piece = 1; piece < 7; piece++) {
+            for (int square = 0; square < 64; square++) {
+                keys.pieces[color][piece][square] = zobristNext(state);
+            }
+        }
+    }
+    // castling keys are built from one key per right so toggling a single right is a single xor
+    uint64_t rights[4] = { zobristNext(state), zobristNext(state), zobristNext(state), zobristNext(state) };
+    for (int mask = 0; mask < 16; mask++) {
+        for (int right = 0; right < 4; right++) {
+            if (mask & (1 << right)) keys.castling[mask] ^= rights[right];
+        }
+    }
+    for (int file = 0; file < 8; file++) {
+        keys.enPassantFile[file] = zobristNext(state);
+    }
+    keys.sideToMove = zobristNext(state);
+    return keys;
+}
+
+inline constexpr ZobristKeys Zobrist = generateZobristKeys();
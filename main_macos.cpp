@@ -121,6 +121,14 @@ int main(int, char**)
     bool show_another_window = false;
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
     ClassGame::GameStartUp();
+
+    // when nothing is moving, sleep until input arrives instead of redrawing at the refresh rate
+    // the timeout still lets the log window pick up new lines now and then
+    const double idleWaitSeconds = 0.25;
+    // frames drawn after an input event so imgui can settle hover and click states
+    int activeFrames = 0;
+    // lets a game's background work (the chess AI's search) wake the loop when it has something to show
+    ClassGame::SetRedrawRequest(glfwPostEmptyEvent);
     
     // Main loop
 #ifdef __EMSCRIPTEN__
@@ -137,7 +145,24 @@ int main(int, char**)
         // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
         // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
         // Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
+#ifdef __EMSCRIPTEN__
         glfwPollEvents();
+#else
+        if (activeFrames > 0 || ClassGame::NeedsContinuousRedraw())
+        {
+            glfwPollEvents();
+            if (activeFrames > 0)
+                activeFrames--;
+        }
+        else
+        {
+            double waitStart = glfwGetTime();
+            glfwWaitEventsTimeout(idleWaitSeconds);
+            // back before the timeout means an event woke us up
+            if (glfwGetTime() - waitStart < idleWaitSeconds)
+                activeFrames = 3;
+        }
+#endif
 
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
@@ -173,6 +198,8 @@ int main(int, char**)
 #endif
 
     // Cleanup
+    // stop the game's background work (the chess AI's search) before glfw goes away under it
+    ClassGame::GameShutDown();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -0,0 +1,516 @@
+// perft: move generator node counter and correctness check for chesscore
+//
+// usage:
+//   perft [depth] [fen]      count the leaf nodes to depth from fen (start position by default),
+//                            printing the count for every root move (divide) and the nodes per second
+//   perft --suite [depth]    run the reference positions below up to depth (4 by default)
+//                            and exit non-zero if any count is wrong
+//   perft --nnue [depth]     write a network of random weights, walk the reference positions to depth (2 by default)
+//                            and check the network's incremental accumulators and kernels at every node
+//
+// node counts come from https://www.chessprogramming.org/Perft_Results
+
+#include "classes/ChessPosition.h"
+#include "classes/MovePicker.h"
+#include "classes/Nnue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct PerftReference {
+    const char* name;
+    const char* fen;
+    std::vector<uint64_t> nodes; // nodes[0] is depth 1
+};
+
+static const PerftReference referencePositions[] = {
+    { "start position", START_FEN,
+        { 20, 400, 8902, 197281, 4865609, 119060324 } },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        { 48, 2039, 97862, 4085603, 193690690 } },
+    { "position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        { 14, 191, 2812, 43238, 674624, 11030083 } },
+    { "position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        { 6, 264, 9467, 422333, 15833292 } },
+    { "position 4 mirrored", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+        { 6, 264, 9467, 422333, 15833292 } },
+    { "position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        { 44, 1486, 62379, 2103487, 89941194 } },
+    { "position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        { 46, 2079, 89890, 3894594, 164075551 } },
+};
+
+// FENs that have to read back as a particular position, the counts are checked against that position's
+struct FenReading {
+    const char* name;
+    const char* fen;
+    const char* expected;
+};
+
+static const FenReading fenReadings[] = {
+    // no black pawn could have just passed e3, and white to move at that, so the field is dropped
+    { "bogus en passant", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e3 0 1", START_FEN },
+    { "en passant after e4", "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1",
+        "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1" },
+};
+
+static uint64_t perft(ChessPosition& position, int depth)
+{
+    MoveList moves;
+    position.generateLegalMoves(moves);
+
+    // bulk count, the legal move list already is the number of leaves one ply down
+    if (depth == 1) {
+        return moves.size();
+    }
+
+    uint64_t nodes = 0;
+    for (auto move : moves) {
+        position.makeMove(move);
+        nodes += perft(position, depth - 1);
+        position.unmakeMove(move);
+    }
+    return nodes;
+}
+
+// the same count, but with the list built the way the search's move picker builds it: tactical moves,
+// then quiet ones. every move also has to come back as legal from isLegalMove and land in the right half,
+// and the running evaluation totals have to match a recount at every node
+static uint64_t stagedPerft(ChessPosition& position, int depth, bool& consistent)
+{
+    int midgame, endgame, phase;
+    position.computeScores(midgame, endgame, phase);
+    if (midgame != position.midgameScore() || endgame != position.endgameScore() || phase != position.gamePhase()) {
+        consistent = false;
+    }
+
+    MoveList moves;
+    position.generateLegalMoves(moves, GenTactical);
+    int tactical = moves.size();
+    position.generateLegalMoves(moves, GenQuiet);
+
+    for (int i = 0; i < moves.size(); i++) {
+        bool isTactical = moves[i].isCapture() || moves[i].isPromotion();
+        if (isTactical != (i < tactical) || !position.isLegalMove(moves[i])) {
+            consistent = false;
+        }
+    }
+
+    if (depth == 1) {
+        return moves.size();
+    }
+
+    uint64_t nodes = 0;
+    for (auto move : moves) {
+        position.makeMove(move);
+        nodes += stagedPerft(position, depth - 1, consistent);
+        position.unmakeMove(move);
+    }
+    return nodes;
+}
+
+// the count once more, this time with every list coming out of a MovePicker the way the search uses it:
+// the hash move and the killers are taken from the node searched just before at the same ply (a sibling
+// position), so some of them don't fit here. the picker has to hand back every legal move exactly once,
+// and nothing else, whatever it was given
+struct PickerWalk {
+    MoveList siblingMoves[8];
+    int history[2][64][64];
+    unsigned int seed;
+};
+
+static bool containsMove(const MoveList& moves, BitMove move)
+{
+    for (auto other : moves) {
+        if (other == move) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t pickerPerft(ChessPosition& position, int depth, int ply, PickerWalk& walk, bool& consistent)
+{
+    MoveList legal;
+    position.generateLegalMoves(legal);
+
+    // the search only keeps quiet moves as killers, so only quiet ones are offered here
+    const MoveList& sibling = walk.siblingMoves[ply];
+    BitMove ttMove, killers[2];
+    int quietFound = 0;
+    if (sibling.size() > 0) {
+        walk.seed = walk.seed * 1103515245 + 12345;
+        ttMove = sibling[(walk.seed >> 8) % sibling.size()];
+        for (int i = (walk.seed >> 16) % sibling.size(), n = 0; n < sibling.size() && quietFound < 2; i = (i + 1) % sibling.size(), n++) {
+            if (!sibling[i].isCapture() && !sibling[i].isPromotion()) {
+                killers[quietFound++] = sibling[i];
+            }
+        }
+    }
+
+    MoveList scratch, picked;
+    int scores[MoveList::Capacity];
+    MovePicker picker(position, scratch, scores, ttMove, killers, walk.history, false);
+    for (BitMove move = picker.next(); !move.isNull(); move = picker.next()) {
+        if (!containsMove(legal, move) || containsMove(picked, move)) {
+            consistent = false;
+            continue;
+        }
+        picked.add(move);
+    }
+    if (picked.size() != legal.size()) {
+        consistent = false;
+    }
+    walk.siblingMoves[ply] = legal;
+
+    if (depth == 1) {
+        return picked.size();
+    }
+
+    uint64_t nodes = 0;
+    for (auto move : picked) {
+        position.makeMove(move);
+        nodes += pickerPerft(position, depth - 1, ply + 1, walk, consistent);
+        position.unmakeMove(move);
+    }
+    return nodes;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int runDivide(const std::string& fen, int depth)
+{
+    ChessPosition position;
+    if (!position.setFEN(fen)) {
+        fprintf(stderr, "invalid FEN: %s\n", fen.c_str());
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    MoveList moves;
+    position.generateLegalMoves(moves);
+
+    uint64_t total = 0;
+    for (auto move : moves) {
+        uint64_t nodes = 1;
+        if (depth > 1) {
+            position.makeMove(move);
+            nodes = perft(position, depth - 1);
+            position.unmakeMove(move);
+        }
+        printf("%s: %llu\n", moveToUCI(move).c_str(), (unsigned long long)nodes);
+        total += nodes;
+    }
+
+    double seconds = secondsSince(start);
+    printf("\nmoves: %d\nnodes: %llu\ntime: %.3fs\nnps: %.0f\n", moves.size(), (unsigned long long)total,
+           seconds, seconds > 0 ? total / seconds : 0.0);
+    return 0;
+}
+
+static int runSuite(int maxDepth)
+{
+    int failures = 0;
+
+    int magicErrors = verifyMagicBitboards();
+    printf("magic bitboards: %s\n", magicErrors ? "FAILED" : "ok");
+    if (magicErrors) failures++;
+
+    uint64_t totalNodes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const auto& reference : referencePositions) {
+        ChessPosition position;
+        position.setFEN(reference.fen);
+
+        // the FEN should come back out exactly as it went in
+        std::string fen = position.toFEN();
+        if (fen != reference.fen) {
+            failures++;
+            printf("%-20s FEN round trip FAILED: %s\n", reference.name, fen.c_str());
+        }
+
+        for (int depth = 1; depth <= maxDepth && depth <= (int)reference.nodes.size(); depth++) {
+            uint64_t expected = reference.nodes[depth - 1];
+            uint64_t nodes = perft(position, depth);
+            totalNodes += nodes;
+
+            bool ok = nodes == expected;
+            if (!ok) failures++;
+            printf("%-20s depth %d: %12llu %s", reference.name, depth, (unsigned long long)nodes, ok ? "ok" : "FAILED");
+            if (!ok) printf(" (expected %llu)", (unsigned long long)expected);
+            printf("\n");
+        }
+
+        // staged generation only needs a few plies to cover checks, pins and promotions
+        int stagedDepth = std::min(3, (int)reference.nodes.size());
+        bool consistent = true;
+        uint64_t stagedNodes = stagedPerft(position, stagedDepth, consistent);
+        bool stagedOk = consistent && stagedNodes == reference.nodes[stagedDepth - 1];
+        if (!stagedOk) failures++;
+        printf("%-20s staged depth %d: %5llu %s\n", reference.name, stagedDepth, (unsigned long long)stagedNodes,
+               stagedOk ? "ok" : "FAILED");
+
+        // the move picker, with some made up history so the quiet moves get shuffled too
+        PickerWalk walk;
+        walk.seed = 1;
+        for (int color = 0; color < 2; color++) {
+            for (int from = 0; from < 64; from++) {
+                for (int to = 0; to < 64; to++) {
+                    walk.history[color][from][to] = ((from * 37 + to * 11 + color * 5) % 200) * 50 - 5000;
+                }
+            }
+        }
+        consistent = true;
+        uint64_t pickerNodes = pickerPerft(position, stagedDepth, 0, walk, consistent);
+        bool pickerOk = consistent && pickerNodes == reference.nodes[stagedDepth - 1];
+        if (!pickerOk) failures++;
+        printf("%-20s picker depth %d: %5llu %s\n", reference.name, stagedDepth, (unsigned long long)pickerNodes,
+               pickerOk ? "ok" : "FAILED");
+    }
+
+    for (const auto& reading : fenReadings) {
+        ChessPosition position, expected;
+        position.setFEN(reading.fen);
+        expected.setFEN(reading.expected);
+
+        std::string fen = position.toFEN();
+        bool ok = fen == reading.expected;
+        int depth = std::min(maxDepth, 3);
+        uint64_t nodes = perft(position, depth);
+        uint64_t expectedNodes = perft(expected, depth);
+        ok = ok && nodes == expectedNodes;
+        if (!ok) failures++;
+        printf("%-20s read as %s, depth %d: %llu %s\n", reading.name, fen.c_str(), depth,
+               (unsigned long long)nodes, ok ? "ok" : "FAILED");
+    }
+
+    double seconds = secondsSince(start);
+    printf("\nnodes: %llu\ntime: %.3fs\nnps: %.0f\n", (unsigned long long)totalNodes, seconds,
+           seconds > 0 ? totalNodes / seconds : 0.0);
+    printf("%s\n", failures ? "FAILED" : "all counts match");
+    return failures ? 1 : 0;
+}
+
+#pragma region NNUE CHECK
+
+// random weights for the network check, kept in memory so the reference evaluation below can use them
+struct RandomNetwork {
+    std::vector<int16_t> featureBiases, featureWeights;
+    std::vector<int32_t> layer1Biases, layer2Biases, outputBias;
+    std::vector<int8_t> layer1Weights, layer2Weights, outputWeights;
+};
+
+static RandomNetwork makeRandomNetwork()
+{
+    // a fixed generator so every run (and every build) sees the same network
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    auto random = [&] (int range) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (int)(state % (uint64_t)(2 * range + 1)) - range;
+    };
+    auto fill = [&] (auto& values, size_t count, int range) {
+        values.resize(count);
+        for (auto& value : values) {
+            value = random(range);
+        }
+    };
+
+    // small enough that no accumulator can overflow, big enough that the layers don't all clip to 0 or 127
+    RandomNetwork network;
+    fill(network.featureBiases, NnueHalfDimensions, 40);
+    fill(network.featureWeights, (size_t)NnueInputs * NnueHalfDimensions, 20);
+    fill(network.layer1Biases, NnueHidden, 2000);
+    fill(network.layer1Weights, (size_t)NnueHidden * NnueHalfDimensions * 2, 127);
+    fill(network.layer2Biases, NnueHidden, 2000);
+    fill(network.layer2Weights, (size_t)NnueHidden * NnueHidden, 127);
+    fill(network.outputBias, 1, 500);
+    fill(network.outputWeights, NnueHidden, 127);
+    return network;
+}
+
+// the file layout from Nnue.h
+static bool writeNetwork(const RandomNetwork& network, const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    auto write = [&] (const auto& values) {
+        while (ftell(file) % 64) {
+            fputc(0, file);
+        }
+        fwrite(values.data(), sizeof(values[0]), values.size(), file);
+    };
+    uint32_t header[4] = { NnueVersion, (uint32_t)NnueInputs, (uint32_t)NnueHalfDimensions, (uint32_t)NnueHidden };
+    fwrite("CBNN", 1, 4, file);
+    fwrite(header, sizeof(header), 1, file);
+    write(network.featureBiases);
+    write(network.featureWeights);
+    write(network.layer1Biases);
+    write(network.layer1Weights);
+    write(network.layer2Biases);
+    write(network.layer2Weights);
+    write(network.outputBias);
+    write(network.outputWeights);
+    return fclose(file) == 0;
+}
+
+// the whole network worked out the slow way from the board, with plain loops and none of NnueNetwork's code
+static int referenceEvaluate(const RandomNetwork& network, const ChessPosition& position)
+{
+    auto clip = [] (int value) { return value < 0 ? 0 : (value > 127 ? 127 : value); };
+
+    int us = position.sideToMove();
+    std::vector<int> input;
+    for (int perspective : { us, us ^ 1 }) {
+        std::vector<int> half(network.featureBiases.begin(), network.featureBiases.end());
+        int king = position.kingSquare(perspective);
+        for (int square = 0; square < 64; square++) {
+            ChessPiece piece = position.pieceAt(square);
+            if (piece == NoPiece || piece == King) {
+                continue;
+            }
+            int flip = perspective == BLACK ? 56 : 0;
+            int pieceIndex = (piece - Pawn) * 2 + (position.colorAt(square) != perspective);
+            size_t feature = (size_t)(king ^ flip) * NnuePieceFeatures + 1 + pieceIndex * 64 + (square ^ flip);
+            for (int i = 0; i < NnueHalfDimensions; i++) {
+                half[i] += network.featureWeights[feature * NnueHalfDimensions + i];
+            }
+        }
+        for (int value : half) {
+            input.push_back(clip(value));
+        }
+    }
+
+    auto layer = [&] (const std::vector<int>& in, const std::vector<int8_t>& weights, const std::vector<int32_t>& biases) {
+        std::vector<int> out(biases.size());
+        for (size_t i = 0; i < out.size(); i++) {
+            int sum = biases[i];
+            for (size_t j = 0; j < in.size(); j++) {
+                sum += in[j] * weights[i * in.size() + j];
+            }
+            out[i] = clip(sum >> NnueWeightScaleBits);
+        }
+        return out;
+    };
+    std::vector<int> hidden1 = layer(input, network.layer1Weights, network.layer1Biases);
+    std::vector<int> hidden2 = layer(hidden1, network.layer2Weights, network.layer2Biases);
+
+    int output = network.outputBias[0];
+    for (int i = 0; i < NnueHidden; i++) {
+        output += hidden2[i] * network.outputWeights[i];
+    }
+    return output / NnueOutputScale;
+}
+
+// every node's accumulator comes from its parent through update(), it has to match a full refresh,
+// and the evaluation has to match both the refreshed accumulator's and the reference one
+static uint64_t nnueWalk(const NnueNetwork& network, const RandomNetwork& weights, ChessPosition& position,
+                         std::vector<NnueAccumulator>& accumulators, int ply, int depth, bool& consistent)
+{
+    NnueAccumulator& accumulator = accumulators[ply];
+    int score = network.evaluate(position, accumulator);
+
+    NnueAccumulator refreshed;
+    network.refresh(position, refreshed, WHITE);
+    network.refresh(position, refreshed, BLACK);
+    if (memcmp(accumulator.values, refreshed.values, sizeof(refreshed.values)) != 0
+        || score != network.evaluate(position, refreshed) || score != referenceEvaluate(weights, position)) {
+        consistent = false;
+    }
+
+    if (depth == 0) {
+        return 1;
+    }
+
+    MoveList moves;
+    position.generateLegalMoves(moves);
+    uint64_t nodes = 1;
+    for (auto move : moves) {
+        network.update(position, move, accumulator, accumulators[ply + 1]);
+        position.makeMove(move);
+        nodes += nnueWalk(network, weights, position, accumulators, ply + 1, depth - 1, consistent);
+        position.unmakeMove(move);
+    }
+    return nodes;
+}
+
+static int runNnueCheck(int depth)
+{
+#if defined(NNUE_NO_SIMD)
+    const char* kernels = "scalar";
+#else
+    const char* kernels = "simd";
+#endif
+    // named after the kernels, so the two builds' checks can run side by side
+    std::string path = (std::filesystem::temp_directory_path() / ("perft-nnue-" + std::string(kernels) + ".nnue")).string();
+
+    RandomNetwork weights = makeRandomNetwork();
+    NnueNetwork network;
+    if (!writeNetwork(weights, path) || !network.load(path)) {
+        printf("nnue (%s): could not write and load %s\nFAILED\n", kernels, path.c_str());
+        return 1;
+    }
+
+    int failures = 0;
+    for (const auto& reference : referencePositions) {
+        ChessPosition position;
+        position.setFEN(reference.fen);
+
+        std::vector<NnueAccumulator> accumulators(depth + 1);
+        network.refresh(position, accumulators[0], WHITE);
+        network.refresh(position, accumulators[0], BLACK);
+
+        bool consistent = true;
+        uint64_t nodes = nnueWalk(network, weights, position, accumulators, 0, depth, consistent);
+        if (!consistent) failures++;
+        printf("%-20s nnue (%s) depth %d: %6llu nodes %s\n", reference.name, kernels, depth,
+               (unsigned long long)nodes, consistent ? "ok" : "FAILED");
+    }
+
+    network.unload();
+    std::error_code error;
+    std::filesystem::remove(path, error);
+
+    printf("%s\n", failures ? "FAILED" : "all evaluations match");
+    return failures ? 1 : 0;
+}
+
+#pragma endregion
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--suite") == 0) {
+        return runSuite(argc > 2 ? atoi(argv[2]) : 4);
+    }
+    if (argc > 1 && strcmp(argv[1], "--nnue") == 0) {
+        return runNnueCheck(argc > 2 ? std::max(1, atoi(argv[2])) : 2);
+    }
+
+    int depth = argc > 1 ? atoi(argv[1]) : 5;
+    if (depth < 1) {
+        fprintf(stderr, "usage: perft [depth] [fen]\n       perft --suite [depth]\n       perft --nnue [depth]\n");
+        return 1;
+    }
+
+    // a FEN passed without quotes arrives as several arguments
+    std::string fen;
+    for (int i = 2; i < argc; i++) {
+        if (!fen.empty()) fen += ' ';
+        fen += argv[i];
+    }
+    return runDivide(fen.empty() ? START_FEN : fen, depth);
+}
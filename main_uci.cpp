@@ -0,0 +1,255 @@
+// chess-uci: the chesscore search behind the UCI protocol on stdin/stdout, no GUI involved
+//
+// supported commands:
+//   uci, isready, ucinewgame, quit
+//   setoption name Hash value <MB>
+//   setoption name Threads value <n>
+//   setoption name EvalFile value <path>     (a network file, see classes/Nnue.h, empty goes back to the hand written evaluation)
+//   position [startpos | fen <fen>] [moves <move> ...]
+//   go [depth <n>] [nodes <n>] [movetime <ms>] [wtime <ms>] [btime <ms>] [winc <ms>] [binc <ms>]
+//      [movestogo <n>] [infinite]
+//   stop
+//
+// the search runs on its own thread so stop, isready and quit are answered while it thinks
+
+#include "classes/ChessPosition.h"
+#include "classes/ChessSearch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+static std::mutex outputLock;
+
+// everything goes out through here, the search thread writes info lines while the main thread answers commands
+static void send(const std::string& line)
+{
+    std::lock_guard<std::mutex> lock(outputLock);
+    std::cout << line << std::endl;
+}
+
+static std::string scoreToUCI(int score)
+{
+    if (score >= MATE_BOUND) {
+        return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+    }
+    if (score <= -MATE_BOUND) {
+        return "mate -" + std::to_string((MATE_SCORE + score) / 2);
+    }
+    return "cp " + std::to_string(score);
+}
+
+// the legal move with this UCI name, a null move if there isn't one
+static BitMove parseMove(const ChessPosition& position, const std::string& text)
+{
+    MoveList moves;
+    position.generateLegalMoves(moves);
+    for (auto move : moves) {
+        if (moveToUCI(move) == text) {
+            return move;
+        }
+    }
+    return BitMove();
+}
+
+class UCIEngine
+{
+public:
+    UCIEngine() : _search(16, 1), _stop(false)
+    {
+        _position.setFEN(START_FEN);
+        _search.setInfoCallback([] (const SearchInfo& info) {
+            std::string line = "info depth " + std::to_string(info.depth)
+                + " score " + scoreToUCI(info.score)
+                + " nodes " + std::to_string(info.nodes)
+                + " nps " + std::to_string(info.nps)
+                + " time " + std::to_string((uint64_t)(info.seconds * 1000.0));
+            if (!info.pv.empty()) {
+                line += " pv";
+                for (auto move : info.pv) {
+                    line += ' ';
+                    line += moveToUCI(move);
+                }
+            }
+            send(line);
+        });
+    }
+
+    ~UCIEngine() { stopSearch(); }
+
+    // returns false once it's time to quit
+    bool command(const std::string& line)
+    {
+        std::istringstream input(line);
+        std::string token;
+        input >> token;
+
+        if (token == "uci") {
+            send("id name chess-base");
+            send("id author chess-base");
+            send("option name Hash type spin default 16 min 1 max 4096");
+            send("option name Threads type spin default 1 min 1 max 256");
+            send("option name EvalFile type string default <empty>");
+            send("uciok");
+        } else if (token == "isready") {
+            send("readyok");
+        } else if (token == "ucinewgame") {
+            stopSearch();
+            _search.clearHash();
+        } else if (token == "setoption") {
+            setOption(input);
+        } else if (token == "position") {
+            setPosition(input);
+        } else if (token == "go") {
+            go(input);
+        } else if (token == "stop") {
+            stopSearch();
+        } else if (token == "quit") {
+            stopSearch();
+            return false;
+        }
+        // anything else is ignored, as the protocol asks
+        return true;
+    }
+
+private:
+    void setOption(std::istringstream& input)
+    {
+        std::string token, name, value;
+        input >> token; // name
+        while (input >> token && token != "value") {
+            name += (name.empty() ? "" : " ") + token;
+        }
+        input >> value;
+
+        // all of these rebuild search state, so never while a search is using it
+        stopSearch();
+        if (name == "Hash") {
+            _search.setHashSize(std::clamp(std::atoi(value.c_str()), 1, 4096));
+        } else if (name == "Threads") {
+            _search.setThreadCount(std::clamp(std::atoi(value.c_str()), 1, 256));
+        } else if (name == "EvalFile") {
+            // the rest of the line, paths can have spaces in them
+            std::string rest;
+            std::getline(input, rest);
+            value += rest;
+            if (value.empty() || value == "<empty>") {
+                _search.unloadNetwork();
+            } else if (_search.loadNetwork(value)) {
+                send("info string loaded network " + value);
+            } else {
+                send("info string could not load network " + value + ", using the hand written evaluation");
+            }
+        }
+    }
+
+    void setPosition(std::istringstream& input)
+    {
+        stopSearch();
+
+        std::string token;
+        input >> token;
+        if (token == "startpos") {
+            _position.setFEN(START_FEN);
+            input >> token; // moves, if there are any
+        } else if (token == "fen") {
+            std::string fen;
+            while (input >> token && token != "moves") {
+                fen += (fen.empty() ? "" : " ") + token;
+            }
+            if (!_position.setFEN(fen)) {
+                send("info string invalid fen " + fen);
+                _position.setFEN(START_FEN);
+                return;
+            }
+        } else {
+            return;
+        }
+
+        while (input >> token) {
+            BitMove move = parseMove(_position, token);
+            if (move.isNull()) {
+                send("info string illegal move " + token);
+                return;
+            }
+            _position.makeMove(move);
+        }
+    }
+
+    void go(std::istringstream& input)
+    {
+        stopSearch();
+
+        SearchLimits limits;
+        int time[2] = { 0, 0 };
+        int increment[2] = { 0, 0 };
+        int movesToGo = 0;
+        bool infinite = false;
+
+        std::string token;
+        while (input >> token) {
+            if (token == "depth") input >> limits.maxDepth;
+            else if (token == "nodes") input >> limits.maxNodes;
+            else if (token == "movetime") input >> limits.moveTimeMs;
+            else if (token == "wtime") input >> time[WHITE];
+            else if (token == "btime") input >> time[BLACK];
+            else if (token == "winc") input >> increment[WHITE];
+            else if (token == "binc") input >> increment[BLACK];
+            else if (token == "movestogo") input >> movesToGo;
+            else if (token == "infinite") infinite = true;
+        }
+
+        // on a clock, spend an even share of what's left plus most of the increment,
+        // and always keep a little back for the time it takes to send the move
+        int color = _position.sideToMove();
+        if (!infinite && limits.moveTimeMs == 0 && time[color] > 0) {
+            int share = time[color] / (movesToGo > 0 ? movesToGo + 1 : 30) + increment[color] * 3 / 4;
+            limits.moveTimeMs = std::max(1, std::min(share, time[color] - 50));
+        }
+
+        _stop = false;
+        limits.stop = &_stop;
+        ChessPosition position = _position;
+        _thinker = std::thread([this, position, limits, infinite] () mutable {
+            BitMove best = _search.think(position, limits);
+            // the search can finish by itself (a mate found, or MAX_PLY), but under go infinite
+            // the protocol only allows bestmove after stop or quit
+            if (infinite) {
+                _stop.wait(false);
+            }
+            send("bestmove " + (best.isNull() ? std::string("0000") : moveToUCI(best)));
+        });
+    }
+
+    void stopSearch()
+    {
+        if (_thinker.joinable()) {
+            _stop = true;
+            _stop.notify_all();
+            _thinker.join();
+        }
+    }
+
+    ChessPosition _position;
+    ChessSearch _search;
+    std::atomic<bool> _stop;
+    std::thread _thinker;
+};
+
+int main()
+{
+    std::ios::sync_with_stdio(false);
+
+    UCIEngine engine;
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (!engine.command(line)) {
+            break;
+        }
+    }
+    return 0;
+}
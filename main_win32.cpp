@@ -169,6 +169,7 @@ int main(int, char**)
     }
 
     // Cleanup
+    ClassGame::GameShutDown();
     ImGui_ImplDX11_Shutdown();
     ImGui_ImplWin32_Shutdown();
     ImGui::DestroyContext();